@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    Cli.h
+  * @brief   Line-oriented command interface for the PCP commands
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __CLI_H__
+#define __CLI_H__
+
+#include "main.h"
+#include "PLUTON-Comms.h"
+#include "Uplink.h"
+
+#define CLI_LINE_SIZE         1024    // characters per line, terminator included (a full frame in hex)
+#define CLI_MAX_OPTDATA       UPLINK_MAX_OPTDATA
+
+typedef struct Cli_verb{
+	const char*   name;               // verb typed by the user
+	uint8_t       functionId;         // CMD_xxx
+	uint8_t       expectResponse;     // answered with functionId + RESPONSE_OFFSET
+} Cli_verb;
+
+// called with a verb found in the table and its parsed optional data
+typedef void (*Cli_commandFn)(const Cli_verb* verb, uint8_t* optData, uint8_t optDataLen);
+// called with one-character lines, the local console controls
+typedef void (*Cli_localFn)(char cmd);
+
+void Cli_init(Cli_commandFn onCommand, Cli_localFn onLocal);
+void Cli_input(char c);
+void Cli_execute(char* line);
+const Cli_verb* Cli_find(const char* name);
+int16_t Cli_parseArgs(char* args, uint8_t* optData, uint8_t maxLen);
+void Cli_printVerbs();
+
+#endif /* __CLI_H__ */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file    Coroutine.h
+  * @brief   Stackless coroutines (protothreads) built on a switch statement
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * A coroutine is a function returning CORO_WAITING or CORO_ENDED that wraps its
+  * body between CORO_BEGIN and CORO_END. It is called again and again and resumes
+  * after the last wait point. Local variables are NOT kept across a wait: keep the
+  * state in the structure that holds the Coro. Two wait points can not share a
+  * source line, and the body can not contain its own switch around a wait point.
+  ******************************************************************************
+  */
+#ifndef __COROUTINE_H__
+#define __COROUTINE_H__
+
+#include <stdint.h>
+
+#define CORO_WAITING          0
+#define CORO_ENDED            1
+
+typedef struct Coro{
+	uint16_t  lc;        // line of the wait point to resume at, 0 at start
+} Coro;
+
+#define CORO_INIT(c)              ((c)->lc = 0)
+
+#define CORO_BEGIN(c)             switch ((c)->lc) { case 0:
+
+#define CORO_END(c)               } (c)->lc = 0; return CORO_ENDED
+
+// suspend until cond is true, cond is evaluated on every resume
+#define CORO_WAIT_UNTIL(c, cond)  do { (c)->lc = __LINE__; case __LINE__: \
+                                       if (!(cond)) return CORO_WAITING; } while (0)
+
+// give the other coroutines a turn
+#define CORO_YIELD(c)             do { (c)->lc = __LINE__; return CORO_WAITING; \
+                                       case __LINE__:; } while (0)
+
+// end the coroutine from anywhere in its body
+#define CORO_EXIT(c)              do { (c)->lc = 0; return CORO_ENDED; } while (0)
+
+#endif /* __COROUTINE_H__ */
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    Correlator.h
+  * @brief   Matches uplink commands with their downlink responses and keeps
+  * 		 round-trip time statistics per command
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __CORRELATOR_H__
+#define __CORRELATOR_H__
+
+#include "main.h"
+#include "PLUTON-Comms.h"
+
+#define CORR_MAX_COMMANDS     NUM_PUBLIC_COMMANDS   // commands tracked at the same time
+#define CORR_SAMPLES          32      // RTT samples kept per command (window)
+#define CORR_TIMEOUT_MS       10000   // a request older than this is counted as lost
+
+typedef struct Corr_entry{
+	uint8_t    functionId;
+	uint8_t    used;
+
+	// request in flight
+	uint8_t    pending;
+	uint32_t   sentTick;
+	uint32_t   sentCycles;       // command handed to the radio
+	uint32_t   txDoneCycles;     // TxDone of the command, 0 while on air
+
+	// statistics
+	uint32_t   samples[CORR_SAMPLES];   // TxDone to response DIO0 edge, us
+	uint8_t    head;
+	uint8_t    count;
+	uint32_t   responses;
+	uint32_t   timeouts;
+	uint32_t   uplinks;
+	uint32_t   min_us;
+	uint32_t   max_us;
+	uint64_t   uplink_us;        // sum of send to TxDone
+	uint64_t   local_us;         // sum of response DIO0 edge to decode
+} Corr_entry;
+
+typedef struct Corr_stats{
+	uint8_t    functionId;
+	uint32_t   responses;
+	uint32_t   timeouts;
+	uint32_t   min_us;
+	uint32_t   mean_us;          // over the sample window
+	uint32_t   max_us;
+	uint32_t   p95_us;           // over the sample window
+	uint32_t   uplink_us;        // mean send to TxDone
+	uint32_t   local_us;         // mean DIO0 edge to decode
+} Corr_stats;
+
+void Corr_init();
+void Corr_sent(uint8_t functionId, uint32_t startCycles);
+void Corr_txDone();
+uint8_t Corr_response(uint8_t functionId, uint32_t edgeCycles);
+void Corr_expire();
+uint8_t Corr_count();
+uint8_t Corr_getStats(uint8_t index, Corr_stats* stats);
+
+#endif /* __CORRELATOR_H__ */
@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file    FramePool.h
+  * @brief   Fixed-block pool of LoRa frame buffers
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __FRAMEPOOL_H__
+#define __FRAMEPOOL_H__
+
+#include "main.h"
+#include "LoRa.h"
+
+#define FRAME_POOL_BLOCKS     16                  // RX ring, decoding and uplink together
+#define FRAME_POOL_BLOCK_SIZE LORA_MAX_PAYLOAD    // bytes, one full frame
+
+typedef struct FramePool_stats{
+	uint32_t   blocks;
+	uint32_t   inUse;
+	uint32_t   highWater;         // most blocks in use at once
+	uint32_t   allocs;
+	uint32_t   failures;          // allocations refused because the pool was empty
+} FramePool_stats;
+
+void FramePool_init();
+uint8_t* FramePool_alloc();
+void FramePool_free(uint8_t* block);
+void FramePool_getStats(FramePool_stats* stats);
+
+#endif /* __FRAMEPOOL_H__ */
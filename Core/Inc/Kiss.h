@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    Kiss.h
+  * @brief   KISS framing of raw frames exchanged with the host PC
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __KISS_H__
+#define __KISS_H__
+
+#include "main.h"
+#include "LoRa.h"
+
+// special characters
+#define KISS_FEND             0xC0
+#define KISS_FESC             0xDB
+#define KISS_TFEND            0xDC
+#define KISS_TFESC            0xDD
+
+// command byte: port in the high nibble, command in the low one
+#define KISS_CMD_DATA         0x00
+#define KISS_CMD_RETURN       0xFF    // leave KISS mode
+#define KISS_PORT_FRAME       0       // raw PCP frames, both directions
+#define KISS_PORT_META        1       // metadata of the frames received by the station
+
+#define KISS_MAX_FRAME        LORA_MAX_PAYLOAD
+
+typedef void (*Kiss_frameFn)(uint8_t command, uint8_t* data, uint16_t len);
+typedef uint16_t (*Kiss_writeFn)(const uint8_t* data, uint16_t len);
+
+typedef struct Kiss_decoder{
+	uint8_t        buffer[KISS_MAX_FRAME + 1];   // command byte and data
+	uint16_t       length;
+	uint8_t        escaped;
+	uint8_t        overflow;
+	Kiss_frameFn   onFrame;
+	uint32_t       frames;
+	uint32_t       errors;          // frames too long or with bad escapes
+} Kiss_decoder;
+
+void Kiss_init(Kiss_decoder* decoder, Kiss_frameFn onFrame);
+void Kiss_decode(Kiss_decoder* decoder, const uint8_t* data, uint16_t len);
+uint16_t Kiss_encode(uint8_t command, const uint8_t* data, uint16_t len, Kiss_writeFn write);
+
+#endif /* __KISS_H__ */
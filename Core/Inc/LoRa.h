@@ -1,9 +1,24 @@
+#ifndef __LORA_H__
+#define __LORA_H__
 
 #include "main.h"
 
 #define TRANSMIT_TIMEOUT	2000
 #define RECEIVE_TIMEOUT		2000
 
+//------ SPI BACKEND ------//
+#define LORA_SPI_BACKEND_HAL	0			// HAL_SPI_Transmit/HAL_SPI_Receive
+#define LORA_SPI_BACKEND_REG	1			// SPIx->DR and FIFO level flags
+#ifndef LORA_SPI_BACKEND
+#define LORA_SPI_BACKEND			LORA_SPI_BACKEND_REG
+#endif
+
+//------ DATASHEET TIMINGS ------//
+#define LORA_RESET_PULSE_US		100		// NRESET low time (> 100 us)
+#define LORA_RESET_WAIT_MS		5			// POR/manual reset to chip ready
+#define LORA_OSC_STARTUP_US		250		// TS_OSC, SLEEP -> any other mode
+#define LORA_MODE_TIMEOUT_US	1000	// bound for the RegOpMode read-back
+
 //--------- MODES ---------//
 #define SLEEP_MODE				0
 #define	STNBY_MODE				1
@@ -50,6 +65,7 @@
 #define RegFrMid							0x07
 #define RegFrLsb							0x08
 #define RegPaConfig						0x09
+#define RegPaRamp							0x0A
 #define RegOcp								0x0B
 #define RegLna								0x0C
 #define RegFiFoAddPtr					0x0D
@@ -58,23 +74,105 @@
 #define RegFiFoRxCurrentAddr	0x10
 #define RegIrqFlags						0x12
 #define RegRxNbBytes					0x13
+#define RegRxHeaderCntValueMsb	0x14
+#define RegRxHeaderCntValueLsb	0x15
+#define RegModemStat					0x18
+#define RegPktSnrValue				0x19
 #define RegPktRssiValue				0x1A
+#define RegHopChannel					0x1C
 #define	RegModemConfig1				0x1D
 #define RegModemConfig2				0x1E
 #define RegSymbTimeoutL				0x1F
 #define RegPreambleMsb				0x20
 #define RegPreambleLsb				0x21
 #define RegPayloadLength			0x22
+#define RegFeiMsb							0x28
+#define RegFeiMid							0x29
+#define RegFeiLsb							0x2A
 #define RegDioMapping1				0x40
 #define RegDioMapping2				0x41
 #define RegVersion						0x42
 
+//------- PAYLOAD -------//
+#define LORA_MAX_PAYLOAD			255	// FIFO payload limit of the SX127x
+
+//----- CONFIG TABLE -----//
+#define LORA_CONFIG_SIZE			16
+
+//----- REGISTER SHADOW -----//
+#define LORA_SHADOW_SIZE			(RegDioMapping2 + 1)
+
+//----- RX METADATA -----//
+#define LORA_RXMETA_FIRST			RegFiFoRxCurrentAddr
+#define LORA_RXMETA_SIZE			(RegModemConfig1 - RegFiFoRxCurrentAddr + 1)
+#define LORA_RSSI_OFFSET			-164	// LF port (433 MHz)
+
+//------- DIO0 EVENTS -------//
+#define LORA_IRQ_NONE				0
+#define LORA_IRQ_RXDONE			1
+#define LORA_IRQ_TXDONE			2
+
+//------- MODEM STATUS -------//
+#define LORA_MODEM_RX_BUSY		0x0B	// signal detected | synchronized | header valid
+
 //------ LORA STATUS ------//
 #define LORA_OK							200
 #define LORA_NOT_FOUND			404
+#define LORA_BUSY						409
 #define LORA_LARGE_PAYLOAD	413
+#define LORA_MISMATCH				417
 #define LORA_UNAVAILABLE		503
 
+typedef struct LoRa_regValue{
+	uint8_t		address;
+	uint8_t		value;
+} LoRa_regValue;
+
+typedef struct LoRa_timing{
+	uint32_t	reset_us;				// LoRa_reset duration
+	uint32_t	init_us;				// LoRa_init duration
+	uint32_t	recovery_us;			// last LoRa_recover duration (reset + init)
+	uint32_t	recoveries;				// number of LoRa_recover calls
+	uint32_t	modeSwitch_us;		// last LoRa_gotoMode duration
+	uint32_t	modeSwitchMax_us;	// worst LoRa_gotoMode duration
+	uint32_t	modeTimeouts;			// mode read-backs that never matched
+	uint32_t	txLoad_us;				// STNBY + FiFo load + TX start
+	uint32_t	txAir_us;					// TX start to TxDone
+	uint32_t	txTurnaround_us;	// TxDone to previous mode restored
+	uint32_t	rxRead_us;				// RxDone service, status burst to FiFo read
+} LoRa_timing;
+
+typedef struct LoRa_rxMeta{
+	uint8_t		length;					// RegRxNbBytes
+	int16_t		rssi;						// packet RSSI, dBm
+	int8_t		snr;						// packet SNR, 0.25 dB steps
+	int32_t		fei;						// frequency error, Hz
+	uint8_t		irqFlags;				// RegIrqFlags before clearing
+	uint8_t		crcError;				// PayloadCrcError raised
+	uint8_t		headerValid;		// ValidHeader raised
+	uint8_t		crcOn;					// CrcOnPayload from the header
+	uint32_t	tick;						// HAL tick at the DIO0 edge
+	uint32_t	cycles;					// DWT cycle count at the DIO0 edge
+} LoRa_rxMeta;
+
+typedef struct LoRa_rxStats{
+	uint32_t	frames;					// packets read from the FiFo
+	uint32_t	lost;						// headers never read, or receptions cut by STNBY
+	uint32_t	deaf_us;				// time spent out of RX to read packets
+	uint16_t	headerCnt;			// RegRxHeaderCntValue at the last read
+} LoRa_rxStats;
+
+typedef struct LoRa_spiBench{
+	uint32_t	iterations;			// accesses measured per backend
+	uint32_t	halRead_cycles;	// single register read, HAL backend
+	uint32_t	regRead_cycles;	// single register read, register backend
+	uint32_t	halWrite_cycles;	// single register write, HAL backend
+	uint32_t	regWrite_cycles;	// single register write, register backend
+} LoRa_spiBench;
+
+struct LoRa_setting;
+typedef void (*LoRa_callback)(struct LoRa_setting* _LoRa);
+
 typedef struct LoRa_setting{
 
 	// Hardware setings:
@@ -84,6 +182,7 @@ typedef struct LoRa_setting{
 	uint16_t			     reset_pin;
 	GPIO_TypeDef*      DIO0_port;
 	uint16_t			     DIO0_pin;
+	IRQn_Type			     DIO0_IRQn;
 	SPI_HandleTypeDef* hSPIx;
 
 	// Module settings:
@@ -96,6 +195,39 @@ typedef struct LoRa_setting{
 	uint8_t			power;
 	uint8_t			overCurrentProtection;
 
+	// DMA transport:
+	volatile uint8_t	dma_busy;
+	LoRa_callback			dma_callback;
+
+	// Bus ownership (masks DIO0 while a SPI sequence is running):
+	volatile uint8_t	lockDepth;
+
+	// Asynchronous transmission:
+	volatile uint8_t	txBusy;
+	volatile uint8_t	txStatus;
+	int								txReturnMode;
+	uint32_t					txStart;
+	LoRa_callback			txDoneCallback;
+
+	// Last received packet:
+	volatile uint32_t	rxTick;
+	volatile uint32_t	rxCycles;
+	uint8_t						rxStatus[LORA_RXMETA_SIZE];	// status burst of the packet being read
+	uint8_t						rxLength;
+	uint8_t						rxPacket;				// RxDone was set, the FiFo is being read
+	uint8_t						rxContinuous;
+	uint32_t					rxStart;
+	LoRa_callback			rxCallback;
+	LoRa_rxMeta				rxMeta;
+	LoRa_rxStats			rxStats;
+
+	// Register shadow (configuration registers owned by the driver):
+	uint8_t			shadow[LORA_SHADOW_SIZE];
+	uint8_t			shadowValid[LORA_SHADOW_SIZE];
+
+	// Per-operation timing report:
+	LoRa_timing	timing;
+
 } LoRa;
 
 LoRa newLoRa(void);
@@ -106,17 +238,42 @@ void LoRa_gotoMode(LoRa* _LoRa, int mode);
 uint8_t LoRa_read(LoRa* _LoRa, uint8_t address);
 void LoRa_write(LoRa* _LoRa, uint8_t address, uint8_t value);
 void LoRa_BurstWrite(LoRa* _LoRa, uint8_t address, uint8_t *value, uint8_t length);
+void LoRa_BurstRead(LoRa* _LoRa, uint8_t address, uint8_t *value, uint8_t length);
 uint8_t LoRa_isvalid(LoRa* _LoRa);
 
+uint8_t LoRa_readCached(LoRa* _LoRa, uint8_t address);
+void LoRa_invalidateShadow(LoRa* _LoRa);
+void LoRa_resync(LoRa* _LoRa);
+uint16_t LoRa_verify(LoRa* _LoRa);
+
+uint16_t LoRa_readReg_DMA(LoRa* _LoRa, uint8_t address, uint8_t* output, uint16_t length, LoRa_callback callback);
+uint16_t LoRa_writeReg_DMA(LoRa* _LoRa, uint8_t address, uint8_t* values, uint16_t length, LoRa_callback callback);
+uint8_t LoRa_isBusy(LoRa* _LoRa);
+void LoRa_DMA_complete(LoRa* _LoRa);
+
 void LoRa_setFrequency(LoRa* _LoRa, int freq);
 void LoRa_setSpreadingFactor(LoRa* _LoRa, int SP);
 void LoRa_setPower(LoRa* _LoRa, uint8_t power);
 void LoRa_setOCP(LoRa* _LoRa, uint8_t current);
 void LoRa_setTOMsb_setCRCon(LoRa* _LoRa);
 uint8_t LoRa_transmit(LoRa* _LoRa, uint8_t* data, uint8_t length, uint16_t timeout);
+uint16_t LoRa_transmit_IT(LoRa* _LoRa, uint8_t* data, uint8_t length, LoRa_callback callback);
+uint8_t LoRa_isTransmitting(LoRa* _LoRa);
+void LoRa_abortTransmit(LoRa* _LoRa);
+uint8_t LoRa_isReceiving(LoRa* _LoRa);
+uint8_t LoRa_onDIO0(LoRa* _LoRa);
+void LoRa_lockBus(LoRa* _LoRa);
+void LoRa_unlockBus(LoRa* _LoRa);
 void LoRa_startReceiving(LoRa* _LoRa);
 uint8_t LoRa_receive(LoRa* _LoRa, uint8_t* data, uint8_t length);
-void LoRa_receive_IT(LoRa* _LoRa, uint8_t* data, uint8_t length);
+uint8_t LoRa_receiveContinuous(LoRa* _LoRa, uint8_t* data, uint8_t length);
+void LoRa_receive_DMA(LoRa* _LoRa, uint8_t* data, uint8_t length, uint8_t continuous, LoRa_callback callback);
 int LoRa_getRSSI(LoRa* _LoRa);
+LoRa_rxMeta* LoRa_getRxMeta(LoRa* _LoRa);
+void LoRa_benchmark(LoRa* _LoRa, uint32_t iterations, LoRa_spiBench* result);
 
+void LoRa_writeTable(LoRa* _LoRa, const LoRa_regValue* table, uint8_t count);
 uint16_t LoRa_init(LoRa* _LoRa);
+uint16_t LoRa_recover(LoRa* _LoRa);
+
+#endif /* __LORA_H__ */
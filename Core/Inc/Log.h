@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    Log.h
+  * @brief   Ring-buffered UART output drained by DMA
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include "main.h"
+
+#define LOG_BUFFER_SIZE       4096    // bytes, power of two
+
+// what log_write does when the buffer is full
+#define LOG_POLICY_DROP       0       // discard the whole message and count it
+#define LOG_POLICY_BLOCK      1       // sleep until the DMA makes room
+#define LOG_BLOCK_TIMEOUT     1000    // ms, longest sleep of a blocked write
+
+typedef struct Log_stats{
+	uint32_t   written;           // bytes accepted
+	uint32_t   dropped;           // bytes discarded because the buffer was full
+	uint32_t   blocked;           // writes that had to wait for room
+	uint32_t   maxDepth;          // most bytes waiting at once
+	uint32_t   depth;             // bytes waiting now
+} Log_stats;
+
+void Log_init(UART_HandleTypeDef* huart, uint8_t policy);
+void Log_setPolicy(uint8_t policy);
+uint8_t Log_getPolicy();
+void Log_setText(uint8_t enabled);
+uint16_t log_write(const uint8_t* data, uint16_t len);
+uint16_t Log_writeRaw(const uint8_t* data, uint16_t len);
+uint16_t log_print(const char* str);
+void Log_onTxComplete(UART_HandleTypeDef* huart);
+void Log_onError(UART_HandleTypeDef* huart);
+uint8_t Log_flush(uint32_t timeout_ms);
+void Log_discard();
+void Log_getStats(Log_stats* stats);
+
+#endif /* __LOG_H__ */
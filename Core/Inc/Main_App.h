@@ -4,6 +4,18 @@
 #include "gpio.h"
 #include "LoRa.h"
 #include "PLUTON-Comms.h"
+#include "FramePool.h"
+#include "RxRing.h"
+#include "Scheduler.h"
+#include "Session.h"
+#include "Correlator.h"
+#include "Uplink.h"
+#include "TimerWheel.h"
+#include "Radio.h"
+#include "Log.h"
+#include "Kiss.h"
+#include "SerialLink.h"
+#include "Cli.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -17,19 +29,70 @@
 #define OUTPUT_POWER          POWER_20db      // dBm
 #define CURRENT_LIMIT         130     // mA
 #define LORA_PREAMBLE_LEN     8       // symbols
+#define TRANSMISSION_TIMEOUT  1000    // ms, well above the SF9/125 kHz time-on-air
+#define RESPONSE_TIMEOUT      3000    // ms, uplink + satellite processing + downlink
+#define RESPONSE_RETRIES      3       // picture bursts requested again on timeout
+#define PICTURE_SLOT          0       // camera slot downloaded by the 'c' command
+#define UART_BENCH_BYTES      16384   // bytes sent by the 'w' throughput test
+#define UART_BENCH_TIMEOUT    5000    // ms, longest wait for the test to drain
+#define EXPIRE_PERIOD         1000    // ms, scan for requests that never got a response
+
+// main loop events
+#define APP_EVT_RADIO         0x01    // frame queued in rxRing
+#define APP_EVT_SERIAL        0x02    // byte queued in uartRxBuffer
+#define APP_EVT_TX_DONE       0x04    // asynchronous transmission finished
+#define APP_EVT_TIMER         0x08    // software timers expired
 
 // satellite callsign
 char callsign[] = "PLUTON-UPV";
 
 /* Private function prototypes -----------------------------------------------*/
 void onInterrupt();
+void onSPITransferComplete();
+void onReceiveDone(LoRa* _LoRa);
+void onTransmitDone(LoRa* _LoRa);
+void onExpireRequests(void* arg);
+void onTimersExpired();
 void sendFrame(uint8_t functionId, uint8_t optDataLe, uint8_t* optData);
 void sendFrame_Default(uint8_t functionId);
 void printControls();
+void printRadioTiming();
+void printRoundTrip();
+void printSPIBenchmark();
+void printRxMeta(LoRa_rxMeta* meta);
+void printUplink();
 void decode(uint8_t* respFrame, uint8_t respLen);
 void sendPing();
+void sendCliCommand(const Cli_verb* verb, uint8_t* optData, uint8_t optDataLen);
 void requestPacketInfo();
-uint8_t setLoRa();
+uint8_t packetInfoSession(Session* s);
+uint16_t pictureBurstId(Session* s);
+uint8_t pictureSession(Session* s);
+void requestPicture();
+uint8_t radioBusy();
+void LoraApp_loopSessions();
+void LoraApp_loopUplink();
+void wakeCommandTasks();
+uint16_t setLoRa();
+void recoverRadio();
 void LoraApp_init();
+void startSerialReception();
+void restartSerialReception();
+void onSerialChunk(uint16_t position);
+void onSerialError();
+void processSerialCommand(char cmd);
+void processSerialChunk(uint8_t* data, uint16_t len);
+void toggleFastLink();
+void printUartThroughput();
+void enterKissMode();
+void onKissFrame(uint8_t command, uint8_t* data, uint16_t len);
+void sendKissFrame();
+void reportKissFrame(RxRing_frame* frame, uint8_t* data);
 void LoraApp_loopSerial();
+void LoraApp_loopTimers();
 void LoraApp_loopReceive();
+void LoraApp_reportTransmission();
+void setAppEvent(uint32_t event);
+uint32_t idlePermille();
+uint32_t LoraApp_waitEvents();
+void LoraApp_loop();
@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file    Radio.h
+  * @brief   Half-duplex arbiter owning the SX127x between reception and
+  * 		 transmission
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __RADIO_H__
+#define __RADIO_H__
+
+#include "main.h"
+#include "LoRa.h"
+#include "TimerWheel.h"
+
+#define RADIO_DEFER_POLL_MS   2       // modem status poll while a TX waits for a reception
+#define RADIO_DEFER_MAX_MS    2000    // longest wait, above the SF9/125 kHz air time of 255 bytes
+
+// arbiter states
+#define RADIO_RX              0       // listening in RX continuous
+#define RADIO_TX_PENDING      1       // frame accepted, waiting for the reception in progress
+#define RADIO_TX              2       // frame on air
+#define RADIO_RECOVERING      3       // reset and re-initialization
+
+typedef struct Radio_stats{
+	uint8_t    state;
+	uint32_t   transmissions;
+	uint32_t   deferred;          // transmissions that waited for a reception to end
+	uint32_t   forced;            // transmissions started after RADIO_DEFER_MAX_MS
+	uint32_t   maxDefer_ms;
+	uint32_t   txDeaf_us;         // time on air and turnaround
+	uint32_t   rxDeaf_us;         // time out of RX to read packets
+	uint32_t   recoveryDeaf_us;   // time spent resetting the radio
+} Radio_stats;
+
+void Radio_init(LoRa* lora, uint16_t txTimeout_ms, LoRa_callback onTxDone);
+uint16_t Radio_transmit(uint8_t* frame, uint8_t len);
+uint8_t Radio_onDIO0();
+uint8_t Radio_busy();
+uint16_t Radio_recover();
+uint32_t Radio_deaf_us();
+void Radio_getStats(Radio_stats* stats);
+
+#endif /* __RADIO_H__ */
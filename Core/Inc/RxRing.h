@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    RxRing.h
+  * @brief   Single-producer/single-consumer ring of received LoRa frames
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __RXRING_H__
+#define __RXRING_H__
+
+#include "main.h"
+#include "LoRa.h"
+#include "FramePool.h"
+
+// number of frames that can wait for the main loop, power of two
+#define RX_RING_SIZE          8
+
+typedef struct RxRing_frame{
+	uint8_t*        buffer;      // payload, a FramePool block
+	uint8_t         length;      // payload length
+	LoRa_rxMeta     meta;        // link metadata and DIO0 timestamp
+} RxRing_frame;
+
+typedef struct RxRing{
+	RxRing_frame       slots[RX_RING_SIZE];
+	uint8_t*           reserved;      // block taken by the last RxRing_reserve
+	volatile uint32_t  head;          // written by the producer (DIO0 interrupt)
+	volatile uint32_t  tail;          // written by the consumer (main loop)
+	volatile uint32_t  overflows;     // frames dropped because the ring was full
+	volatile uint32_t  maxDepth;      // highest number of frames waiting
+} RxRing;
+
+void RxRing_init(RxRing* ring);
+uint8_t* RxRing_reserve(RxRing* ring);
+void RxRing_commit(RxRing* ring, uint8_t length, LoRa_rxMeta* meta);
+RxRing_frame* RxRing_peek(RxRing* ring);
+uint8_t* RxRing_data(RxRing* ring, RxRing_frame* frame);
+void RxRing_release(RxRing* ring);
+uint32_t RxRing_depth(RxRing* ring);
+
+#endif /* __RXRING_H__ */
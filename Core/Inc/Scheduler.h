@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    Scheduler.h
+  * @brief   Cooperative run-to-completion task scheduler with priorities and
+  * 		 deadlines
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include "main.h"
+
+#define SCHED_MAX_TASKS       8
+#define SCHED_NO_TASK         (-1)
+
+// priority levels, lower value runs first
+#define SCHED_PRIO_RADIO      0
+#define SCHED_PRIO_RX         1
+#define SCHED_PRIO_SERIAL     2
+#define SCHED_PRIO_PRINT      3
+
+typedef void (*Sched_taskFn)(void);
+
+typedef struct Sched_task{
+	const char*        name;
+	Sched_taskFn       run;
+	uint8_t            priority;
+	uint32_t           period_ms;      // 0 for event-driven tasks
+	uint32_t           deadline_ms;    // release to completion bound
+	volatile uint8_t   ready;
+	volatile uint32_t  releaseTick;    // HAL tick of the first pending release
+	uint32_t           nextTick;       // next periodic release
+	uint32_t           runs;
+	uint32_t           misses;         // completions later than the deadline
+	uint32_t           lateness_ms;    // worst completion time past the deadline
+	uint32_t           maxRun_us;      // longest single run
+} Sched_task;
+
+void Sched_init();
+int8_t Sched_add(const char* name, Sched_taskFn run, uint8_t priority, uint32_t period_ms, uint32_t deadline_ms);
+void Sched_signal(int8_t id);
+uint8_t Sched_runNext();
+uint8_t Sched_count();
+Sched_task* Sched_get(int8_t id);
+uint32_t Sched_misses();
+
+#endif /* __SCHEDULER_H__ */
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file    SerialLink.h
+  * @brief   Baud rate negotiation and flow control of the host UART
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __SERIALLINK_H__
+#define __SERIALLINK_H__
+
+#include "main.h"
+#include "TimerWheel.h"
+
+#define LINK_DEFAULT_BAUD     115200    // boot rate, no flow control
+#define LINK_FAST_BAUD        3000000   // PCLK1 / 12, exact with 8x oversampling
+#define LINK_CONFIRM_MS       2000      // time the host has to answer at the new rate
+#define LINK_CONFIRM_BYTE     'A'       // sent by the host once it has switched
+#define LINK_FLUSH_MS         200       // longest wait for the output before a switch
+
+// link states
+#define LINK_DEFAULT          0
+#define LINK_CONFIRMING       1         // switched, waiting for the host
+#define LINK_FAST             2
+
+typedef void (*Link_restartFn)(void);
+
+typedef struct Link_stats{
+	uint32_t   baud;              // current rate
+	uint8_t    flowControl;       // RTS/CTS enabled
+	uint8_t    state;             // LINK_xxx
+	uint32_t   switches;          // negotiations confirmed by the host
+	uint32_t   fallbacks;         // negotiations that timed out
+} Link_stats;
+
+void Link_init(UART_HandleTypeDef* huart, Link_restartFn restart);
+uint16_t Link_negotiate(uint32_t baud);
+void Link_fallback();
+uint8_t Link_confirming();
+uint8_t Link_onByte(uint8_t byte);
+void Link_getStats(Link_stats* stats);
+
+#endif /* __SERIALLINK_H__ */
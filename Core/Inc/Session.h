@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    Session.h
+  * @brief   Request/response command sessions multiplexed on one radio
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __SESSION_H__
+#define __SESSION_H__
+
+#include "main.h"
+#include "Coroutine.h"
+#include "LoRa.h"
+#include "TimerWheel.h"
+
+#define SESSION_MAX           4
+#define SESSION_NO_RESPONSE   0xFF
+
+// result of the last SESSION_AWAIT
+#define SESSION_OK            0
+#define SESSION_TIMEOUT       1
+
+typedef struct Session Session;
+typedef uint8_t (*Session_thread)(Session* s);
+typedef void (*Session_sendFn)(uint8_t functionId, uint8_t optDataLen, uint8_t* optData);
+typedef uint8_t (*Session_busyFn)(void);
+typedef void (*Session_wakeFn)(void);
+
+struct Session{
+	Coro             coro;
+	Session_thread   thread;
+	const char*      name;
+	uint8_t          active;
+	uint32_t         sequence;        // start order, the lowest is the oldest
+
+	// awaited response
+	uint8_t          expect;          // RESP_xxx or SESSION_NO_RESPONSE
+	Timer            timer;           // response timeout
+	volatile uint8_t timedOut;
+	volatile uint8_t received;
+	uint8_t          status;          // SESSION_OK or SESSION_TIMEOUT
+	uint8_t          response[LORA_MAX_PAYLOAD];
+	uint8_t          responseLen;
+
+	// scratch state of the session, kept across waits
+	uint8_t          request[8];
+	uint32_t         arg;
+	uint32_t         total;
+	uint32_t         done;
+	uint16_t         index;
+	uint8_t          retries;
+};
+
+// send a frame as soon as the radio is free
+#define SESSION_SEND(s, functionId, optDataLen, optData) \
+	do { CORO_WAIT_UNTIL(&(s)->coro, !Session_radioBusy()); \
+	     Session_send((functionId), (optDataLen), (optData)); } while (0)
+
+// wait for the response, or for timeout_ms; the outcome is left in s->status
+#define SESSION_AWAIT(s, responseId, timeout_ms) \
+	do { Session_expect((s), (responseId), (timeout_ms)); \
+	     CORO_WAIT_UNTIL(&(s)->coro, Session_settled(s)); } while (0)
+
+void Session_init(Session_sendFn send, Session_busyFn busy, Session_wakeFn wake);
+Session* Session_start(const char* name, Session_thread thread, uint32_t arg);
+uint8_t Session_deliver(uint8_t functionId, uint8_t* optData, uint8_t optDataLen);
+uint8_t Session_runAll();
+uint8_t Session_active();
+
+uint8_t Session_radioBusy();
+void Session_send(uint8_t functionId, uint8_t optDataLen, uint8_t* optData);
+void Session_expect(Session* s, uint8_t responseId, uint32_t timeout_ms);
+uint8_t Session_settled(Session* s);
+
+#endif /* __SESSION_H__ */
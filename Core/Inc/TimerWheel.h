@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file    TimerWheel.h
+  * @brief   Hierarchical software timer wheel driven by SysTick
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __TIMERWHEEL_H__
+#define __TIMERWHEEL_H__
+
+#include "main.h"
+
+#define TIMER_LEVELS          3
+#define TIMER_SLOT_BITS       5
+#define TIMER_SLOTS           (1U << TIMER_SLOT_BITS)
+#define TIMER_SLOT_MASK       (TIMER_SLOTS - 1)
+#define TIMER_RANGE           (1UL << (TIMER_LEVELS * TIMER_SLOT_BITS))   // ms, 32.7 s
+
+// timer states
+#define TIMER_IDLE            0
+#define TIMER_ARMED           1
+#define TIMER_EXPIRED         2
+
+typedef void (*Timer_callback)(void* arg);
+typedef void (*Timer_notifyFn)(void);
+
+typedef struct Timer{
+	struct Timer*      next;
+	struct Timer*      prev;
+	struct Timer**     list;           // list holding the timer, NULL when idle
+	uint32_t           expires;        // wheel tick
+	uint32_t           period;         // ms, 0 for one-shot timers
+	Timer_callback     callback;
+	void*              arg;
+	volatile uint8_t   state;
+} Timer;
+
+void Timer_init(Timer_notifyFn notify);
+void Timer_start(Timer* t, uint32_t delay_ms, uint32_t period_ms, Timer_callback callback, void* arg);
+void Timer_stop(Timer* t);
+uint8_t Timer_armed(Timer* t);
+void Timer_tick();
+uint8_t Timer_dispatch();
+uint32_t Timer_now();
+
+#endif /* __TIMERWHEEL_H__ */
@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    Uplink.h
+  * @brief   Bounded queue of uplink commands drained back to back during a pass
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+#ifndef __UPLINK_H__
+#define __UPLINK_H__
+
+#include "main.h"
+#include "LoRa.h"
+#include "TimerWheel.h"
+
+#define UPLINK_QUEUE_SIZE     16      // commands waiting to be sent
+#define UPLINK_CALLSIGN_LEN   10      // characters of the callsign, "PLUTON-UPV"
+// optional data bytes per queued command: a full frame minus callsign, function ID and length
+#define UPLINK_MAX_OPTDATA    (LORA_MAX_PAYLOAD - UPLINK_CALLSIGN_LEN - 2)
+
+typedef struct Uplink_cmd{
+	uint8_t    functionId;
+	uint8_t    optDataLen;
+	uint8_t    optData[UPLINK_MAX_OPTDATA];
+	uint8_t    expectResponse;    // leave the response window open after it
+} Uplink_cmd;
+
+typedef struct Uplink_stats{
+	uint32_t   depth;             // commands queued, the staged one included
+	uint32_t   maxDepth;
+	uint32_t   sent;              // commands on air since boot
+	uint32_t   failed;            // transmissions that timed out
+	uint32_t   noResponse;        // response windows that expired
+	uint32_t   dropped;           // pushes refused because the queue was full
+	uint32_t   perMinute;         // commands per minute of the current/last burst
+} Uplink_stats;
+
+typedef uint16_t (*Uplink_transmitFn)(uint8_t* frame, uint8_t len);
+typedef void (*Uplink_wakeFn)(void);
+
+void Uplink_init(char* callsign, uint16_t window_ms, Uplink_transmitFn transmit, Uplink_wakeFn wake);
+uint16_t Uplink_push(uint8_t functionId, uint8_t optDataLen, uint8_t* optData, uint8_t expectResponse);
+void Uplink_poll();
+void Uplink_txDone(uint8_t success);
+void Uplink_response(uint8_t functionId);
+uint8_t Uplink_idle();
+void Uplink_getStats(Uplink_stats* stats);
+
+#endif /* __UPLINK_H__ */
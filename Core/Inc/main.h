@@ -53,6 +53,19 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void delay_ms(uint32_t ms);
+void delay_us(uint32_t us);
+void cycles_init(void);
+uint32_t get_cycles(void);
+uint32_t cycles_to_us(uint32_t cycles);
+
+/* Main_App entry points called from main.c and its HAL callbacks */
+void LoraApp_init(void);
+void LoraApp_loop(void);
+void onInterrupt(void);
+void onSPITransferComplete(void);
+void onSerialChunk(uint16_t position);
+void onSerialError(void);
 
 /* USER CODE END EFP */
 
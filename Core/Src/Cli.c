@@ -0,0 +1,332 @@
+/**
+  ******************************************************************************
+  * @file    Cli.c
+  * @brief   Line-oriented command interface for the PCP commands
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * A line is a verb followed by arguments separated by spaces, e.g.
+  *
+  *   get-flash-contents 0x00010000:4 128
+  *   set-callsign "PLUTON-UPV"
+  *
+  * Every CMD_xxx of PLUTON-Comms.h has a verb, its name in lower case with
+  * dashes. The verbs are kept sorted so the lookup is a binary search. Each
+  * argument becomes optional data bytes, in order:
+  *
+  *   123, -5, 0x7F   integer, 1 byte
+  *   1000:2, 7:4     integer with its width in bytes, little endian
+  *   1.5             float, 4 bytes
+  *   "text"          the characters between the quotes
+  *
+  * One-character lines are the local console controls.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Cli.h"
+#include "Log.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// sorted by name, checked by Cli_init
+static const Cli_verb verbs[] = {
+	{ "abort",                     CMD_ABORT,                     0 },
+	{ "camera-capture",            CMD_CAMERA_CAPTURE,            0 },
+	{ "deploy",                    CMD_DEPLOY,                    0 },
+	{ "detumble",                  CMD_DETUMBLE,                  0 },
+	{ "erase-flash",               CMD_ERASE_FLASH,               0 },
+	{ "get-flash-contents",        CMD_GET_FLASH_CONTENTS,        0 },
+	{ "get-full-system-info",      CMD_GET_FULL_SYSTEM_INFO,      1 },
+	{ "get-gps-log",               CMD_GET_GPS_LOG,               0 },
+	{ "get-gps-log-state",         CMD_GET_GPS_LOG_STATE,         0 },
+	{ "get-packet-info",           CMD_GET_PACKET_INFO,           1 },
+	{ "get-picture-burst",         CMD_GET_PICTURE_BURST,         0 },
+	{ "get-picture-length",        CMD_GET_PICTURE_LENGTH,        0 },
+	{ "get-statistics",            CMD_GET_STATISTICS,            1 },
+	{ "log-gps",                   CMD_LOG_GPS,                   0 },
+	{ "maneuver",                  CMD_MANEUVER,                  0 },
+	{ "ping",                      CMD_PING,                      1 },
+	{ "record-imu",                CMD_RECORD_IMU,                0 },
+	{ "record-solar-cells",        CMD_RECORD_SOLAR_CELLS,        0 },
+	{ "request-public-picture",    CMD_REQUEST_PUBLIC_PICTURE,    1 },
+	{ "restart",                   CMD_RESTART,                   0 },
+	{ "retransmit",                CMD_RETRANSMIT,                1 },
+	{ "retransmit-custom",         CMD_RETRANSMIT_CUSTOM,         1 },
+	{ "route",                     CMD_ROUTE,                     0 },
+	{ "run-gps-command",           CMD_RUN_GPS_COMMAND,           0 },
+	{ "run-manual-acs",            CMD_RUN_MANUAL_ACS,            0 },
+	{ "set-adcs-controller",       CMD_SET_ADCS_CONTROLLER,       0 },
+	{ "set-adcs-ephemerides",      CMD_SET_ADCS_EPHEMERIDES,      0 },
+	{ "set-adcs-parameters",       CMD_SET_ADCS_PARAMETERS,       0 },
+	{ "set-callsign",              CMD_SET_CALLSIGN,              0 },
+	{ "set-flash-contents",        CMD_SET_FLASH_CONTENTS,        0 },
+	{ "set-imu-calibration",       CMD_SET_IMU_CALIBRATION,       0 },
+	{ "set-imu-offset",            CMD_SET_IMU_OFFSET,            0 },
+	{ "set-low-power-enable",      CMD_SET_LOW_POWER_ENABLE,      0 },
+	{ "set-mppt-mode",             CMD_SET_MPPT_MODE,             0 },
+	{ "set-power-limits",          CMD_SET_POWER_LIMITS,          0 },
+	{ "set-receive-windows",       CMD_SET_RECEIVE_WINDOWS,       0 },
+	{ "set-rtc",                   CMD_SET_RTC,                   0 },
+	{ "set-sf-mode",               CMD_SET_SF_MODE,               0 },
+	{ "set-sleep-intervals",       CMD_SET_SLEEP_INTERVALS,       0 },
+	{ "set-tle",                   CMD_SET_TLE,                   0 },
+	{ "set-transmit-enable",       CMD_SET_TRANSMIT_ENABLE,       0 },
+	{ "store-and-forward-add",     CMD_STORE_AND_FORWARD_ADD,     1 },
+	{ "store-and-forward-request", CMD_STORE_AND_FORWARD_REQUEST, 1 },
+	{ "transmit-system-info",      CMD_TRANSMIT_SYSTEM_INFO,      1 },
+	{ "wipe-eeprom",               CMD_WIPE_EEPROM,               0 },
+};
+
+#define CLI_VERB_COUNT        (sizeof(verbs) / sizeof(verbs[0]))
+
+static char           lineBuffer[CLI_LINE_SIZE];
+static uint16_t       lineLen = 0;
+static uint8_t        lineOverflow = 0;
+static Cli_commandFn  cliCommand = NULL;
+static Cli_localFn    cliLocal = NULL;
+
+/**
+ * @brief   Compare a name with a verb, for bsearch.
+ *
+ * @param   key    The name.
+ * @param   elem   The verb.
+ *
+ * @return  As strcmp.
+ */
+static int Cli_compare(const void* key, const void* elem) {
+	return strcmp((const char*)key, ((const Cli_verb*)elem)->name);
+}
+
+/**
+ * @brief   Initialize the command interface.
+ *
+ * @param   onCommand   Sends a satellite command.
+ * @param   onLocal     Runs a local console control.
+ *
+ * @return  None
+ */
+void Cli_init(Cli_commandFn onCommand, Cli_localFn onLocal) {
+	cliCommand = onCommand;
+	cliLocal = onLocal;
+	lineLen = 0;
+	lineOverflow = 0;
+
+	for (uint8_t i = 1; i < CLI_VERB_COUNT; i++) {
+		if (strcmp(verbs[i - 1].name, verbs[i].name) >= 0) {
+			log_print("cli: verb table not sorted\r\n");
+			break;
+		}
+	}
+}
+
+/**
+ * @brief   Feed a received character.
+ *
+ * @details Characters are echoed. Backspace and DEL erase the last one, CR or LF runs the
+ *          line. A line longer than CLI_LINE_SIZE - 1 characters is discarded.
+ *
+ * @param   c   Received character.
+ *
+ * @return  None
+ */
+void Cli_input(char c) {
+	if (c == '\r' || c == '\n') {
+		if (lineLen == 0 && !lineOverflow) {
+			return;
+		}
+		log_print("\r\n");
+		if (lineOverflow) {
+			log_print("line too long\r\n");
+		} else {
+			lineBuffer[lineLen] = '\0';
+			Cli_execute(lineBuffer);
+		}
+		lineLen = 0;
+		lineOverflow = 0;
+		return;
+	}
+	if (c == '\b' || c == 0x7F) {
+		if (lineLen > 0) {
+			lineLen--;
+			log_print("\b \b");
+		}
+		return;
+	}
+	if (c < ' ' || c > '~') {
+		return;
+	}
+	if (lineLen >= CLI_LINE_SIZE - 1) {
+		lineOverflow = 1;
+		return;
+	}
+	lineBuffer[lineLen++] = c;
+	log_write((uint8_t*)&c, 1);
+}
+
+/**
+ * @brief   Run a complete line.
+ *
+ * @param   line   The line, modified while parsing.
+ *
+ * @return  None
+ */
+void Cli_execute(char* line) {
+	while (*line == ' ') {
+		line++;
+	}
+	char* args = line;
+	while (*args != ' ' && *args != '\0') {
+		args++;
+	}
+	if (*args != '\0') {
+		*args++ = '\0';
+	}
+
+	if (line[0] != '\0' && line[1] == '\0') {
+		if (cliLocal != NULL) {
+			cliLocal(line[0]);
+		}
+		return;
+	}
+	if (strcmp(line, "help") == 0) {
+		Cli_printVerbs();
+		return;
+	}
+
+	const Cli_verb* verb = Cli_find(line);
+	if (verb == NULL) {
+		log_print("unknown verb, try help\r\n");
+		return;
+	}
+	uint8_t optData[CLI_MAX_OPTDATA];
+	int16_t optDataLen = Cli_parseArgs(args, optData, sizeof(optData));
+	if (optDataLen < 0) {
+		return;
+	}
+	if (cliCommand != NULL) {
+		cliCommand(verb, optData, optDataLen);
+	}
+}
+
+/**
+ * @brief   Look up a verb.
+ *
+ * @param   name   The verb.
+ *
+ * @return  The table entry, NULL if the verb does not exist.
+ */
+const Cli_verb* Cli_find(const char* name) {
+	return bsearch(name, verbs, CLI_VERB_COUNT, sizeof(Cli_verb), Cli_compare);
+}
+
+/**
+ * @brief   Convert the arguments of a line into optional data.
+ *
+ * @details Errors are reported on the console.
+ *
+ * @param   args      The arguments, modified while parsing.
+ * @param   optData   Where the bytes are stored.
+ * @param   maxLen    Size of optData.
+ *
+ * @return  The number of bytes, -1 if an argument is invalid or they do not fit.
+ */
+int16_t Cli_parseArgs(char* args, uint8_t* optData, uint8_t maxLen) {
+	uint8_t len = 0;
+	char* p = args;
+
+	while (1) {
+		while (*p == ' ') {
+			p++;
+		}
+		if (*p == '\0') {
+			return len;
+		}
+
+		// quoted text
+		if (*p == '"') {
+			char* end = strchr(++p, '"');
+			if (end == NULL) {
+				log_print("missing closing quote\r\n");
+				return -1;
+			}
+			if (end - p > maxLen - len) {
+				log_print("arguments too long\r\n");
+				return -1;
+			}
+			memcpy(&optData[len], p, end - p);
+			len += end - p;
+			p = end + 1;
+			continue;
+		}
+
+		char* token = p;
+		while (*p != ' ' && *p != '\0') {
+			p++;
+		}
+		if (*p != '\0') {
+			*p++ = '\0';
+		}
+
+		uint8_t width = 1;
+		uint8_t bytes[4];
+		char* end;
+		if (strchr(token, '.') != NULL) {
+			float value = strtof(token, &end);
+			width = sizeof(float);
+			memcpy(bytes, &value, sizeof(float));
+		} else {
+			long long value = strtoll(token, &end, 0);
+			if (*end == ':') {
+				unsigned long requested = strtoul(end + 1, &end, 10);
+				width = (requested == 1 || requested == 2 || requested == 4) ? requested : 0;
+			}
+			if (width == 0) {
+				log_print("width must be 1, 2 or 4\r\n");
+				return -1;
+			}
+			long long limit = 1LL << (8 * width);
+			if (value < -limit / 2 || value >= limit) {
+				log_print("value out of range: ");
+				log_print(token);
+				log_print("\r\n");
+				return -1;
+			}
+			for (uint8_t i = 0; i < width; i++) {
+				bytes[i] = (uint8_t)((unsigned long long)value >> (8 * i));
+			}
+		}
+		if (*end != '\0' || end == token) {
+			log_print("invalid argument: ");
+			log_print(token);
+			log_print("\r\n");
+			return -1;
+		}
+		if (width > maxLen - len) {
+			log_print("arguments too long\r\n");
+			return -1;
+		}
+		memcpy(&optData[len], bytes, width);
+		len += width;
+	}
+}
+
+/**
+ * @brief   Print every verb with its function ID.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Cli_printVerbs() {
+	char text[48];
+
+	log_print("--------- Satellite commands -------\r\n");
+	for (uint8_t i = 0; i < CLI_VERB_COUNT; i++) {
+		snprintf(text, sizeof(text), "%-26s 0x%02X\r\n", verbs[i].name, verbs[i].functionId);
+		log_print(text);
+	}
+	log_print("args: 12, -3, 0x1F, 1000:2, 7:4, 1.5, \"text\"\r\n");
+	log_print("------------------------------------\r\n");
+}
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file    Correlator.c
+  * @brief   Matches uplink commands with their downlink responses and keeps
+  * 		 round-trip time statistics per command
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * The round trip of a command is split in three parts:
+  *  - uplink:    command handed to the radio until its TxDone (our TX path)
+  *  - RTT:       TxDone until the DIO0 edge of the response (satellite
+  *               processing plus both times on air)
+  *  - local:     DIO0 edge until the response is decoded (our RX path)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Correlator.h"
+#include <string.h>
+
+static Corr_entry entries[CORR_MAX_COMMANDS];
+static Corr_entry* onAir = NULL;
+
+/**
+ * @brief   Clear the correlation table.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Corr_init() {
+	memset(entries, 0, sizeof(entries));
+	onAir = NULL;
+}
+
+/**
+ * @brief   Find the entry of a command, optionally allocating it.
+ *
+ * @details When the table is full the entry sent the longest time ago, and not waiting
+ *          for a response if possible, is reused for the new command.
+ *
+ * @param   functionId   Command function ID.
+ * @param   create       Allocate an entry if the command is not tracked yet.
+ *
+ * @return  A pointer to the entry, or NULL.
+ */
+static Corr_entry* Corr_find(uint8_t functionId, uint8_t create) {
+	for (uint8_t i = 0; i < CORR_MAX_COMMANDS; i++) {
+		if (entries[i].used && entries[i].functionId == functionId) {
+			return &entries[i];
+		}
+	}
+	if (!create) {
+		return NULL;
+	}
+	Corr_entry* victim = NULL;
+	uint32_t now = HAL_GetTick();
+	for (uint8_t i = 0; i < CORR_MAX_COMMANDS; i++) {
+		Corr_entry* entry = &entries[i];
+		if (!entry->used) {
+			victim = entry;
+			break;
+		}
+		if (victim == NULL || (victim->pending && !entry->pending) ||
+				(victim->pending == entry->pending && now - entry->sentTick > now - victim->sentTick)) {
+			victim = entry;
+		}
+	}
+	if (victim == onAir) {
+		onAir = NULL;
+	}
+	memset(victim, 0, sizeof(Corr_entry));
+	victim->used = 1;
+	victim->functionId = functionId;
+	victim->min_us = UINT32_MAX;
+	return victim;
+}
+
+/**
+ * @brief   Record a command handed to the radio.
+ *
+ * @details Call it once the radio accepted the frame. Only the public commands are tracked,
+ *          the others are not answered with functionId + RESPONSE_OFFSET and would only
+ *          count timeouts. A previous request of the same command still waiting for its
+ *          response is counted as a timeout.
+ *
+ * @param   functionId    Command function ID.
+ * @param   startCycles   Cycle count taken before the frame was built and loaded.
+ *
+ * @return  None
+ */
+void Corr_sent(uint8_t functionId, uint32_t startCycles) {
+	// the TxDone of this frame belongs to no tracked command
+	onAir = NULL;
+	if (functionId >= NUM_PUBLIC_COMMANDS) {
+		return;
+	}
+	Corr_entry* entry = Corr_find(functionId, 1);
+	if (entry->pending) {
+		entry->timeouts++;
+	}
+	entry->pending = 1;
+	entry->sentTick = HAL_GetTick();
+	entry->sentCycles = startCycles;
+	entry->txDoneCycles = 0;
+	onAir = entry;
+}
+
+/**
+ * @brief   Record the TxDone of the last command sent.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Corr_txDone() {
+	uint32_t now = get_cycles();
+	if (onAir == NULL) {
+		return;
+	}
+	// 0 is reserved for "still on air"
+	onAir->txDoneCycles = now != 0 ? now : 1;
+	onAir->uplink_us += cycles_to_us(now - onAir->sentCycles);
+	onAir->uplinks++;
+	onAir = NULL;
+}
+
+/**
+ * @brief   Match a received frame with the command it answers.
+ *
+ * @details The command is functionId - RESPONSE_OFFSET. Call it once the frame is decoded.
+ *
+ * @param   functionId   Function ID of the received frame.
+ * @param   edgeCycles   Cycle count of the DIO0 edge of the frame.
+ *
+ * @return  1 if the frame answered a pending command, otherwise 0.
+ */
+uint8_t Corr_response(uint8_t functionId, uint32_t edgeCycles) {
+	if (functionId < RESPONSE_OFFSET) {
+		return 0;
+	}
+	Corr_entry* entry = Corr_find(functionId - RESPONSE_OFFSET, 0);
+	if (entry == NULL || !entry->pending || entry->txDoneCycles == 0) {
+		return 0;
+	}
+
+	uint32_t rtt = cycles_to_us(edgeCycles - entry->txDoneCycles);
+	entry->pending = 0;
+	entry->responses++;
+	entry->local_us += cycles_to_us(get_cycles() - edgeCycles);
+	entry->samples[entry->head] = rtt;
+	entry->head = (entry->head + 1) % CORR_SAMPLES;
+	if (entry->count < CORR_SAMPLES) {
+		entry->count++;
+	}
+	if (rtt < entry->min_us) {
+		entry->min_us = rtt;
+	}
+	if (rtt > entry->max_us) {
+		entry->max_us = rtt;
+	}
+	return 1;
+}
+
+/**
+ * @brief   Count the requests that waited longer than CORR_TIMEOUT_MS as timeouts.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Corr_expire() {
+	uint32_t now = HAL_GetTick();
+	for (uint8_t i = 0; i < CORR_MAX_COMMANDS; i++) {
+		Corr_entry* entry = &entries[i];
+		if (entry->used && entry->pending && now - entry->sentTick > CORR_TIMEOUT_MS) {
+			entry->pending = 0;
+			entry->timeouts++;
+		}
+	}
+}
+
+/**
+ * @brief   Get the number of commands tracked.
+ *
+ * @param   None
+ *
+ * @return  The number of table entries in use.
+ */
+uint8_t Corr_count() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < CORR_MAX_COMMANDS; i++) {
+		count += entries[i].used;
+	}
+	return count;
+}
+
+/**
+ * @brief   Compute the statistics of a tracked command.
+ *
+ * @details Mean and 95th percentile are computed over the last CORR_SAMPLES responses,
+ *          min and max over every response.
+ *
+ * @param   index   Entry number, from 0 to Corr_count() - 1.
+ * @param   stats   Where the statistics are stored.
+ *
+ * @return  1 if the entry exists, otherwise 0.
+ */
+uint8_t Corr_getStats(uint8_t index, Corr_stats* stats) {
+	Corr_entry* entry = NULL;
+	for (uint8_t i = 0, n = 0; i < CORR_MAX_COMMANDS; i++) {
+		if (entries[i].used && n++ == index) {
+			entry = &entries[i];
+			break;
+		}
+	}
+	if (entry == NULL) {
+		return 0;
+	}
+
+	memset(stats, 0, sizeof(Corr_stats));
+	stats->functionId = entry->functionId;
+	stats->responses  = entry->responses;
+	stats->timeouts   = entry->timeouts;
+	if (entry->count == 0) {
+		return 1;
+	}
+
+	// sort a copy of the window (insertion sort, at most CORR_SAMPLES values)
+	uint32_t sorted[CORR_SAMPLES];
+	uint64_t sum = 0;
+	for (uint8_t i = 0; i < entry->count; i++) {
+		uint32_t value = entry->samples[i];
+		int8_t j = i - 1;
+		while (j >= 0 && sorted[j] > value) {
+			sorted[j + 1] = sorted[j];
+			j--;
+		}
+		sorted[j + 1] = value;
+		sum += value;
+	}
+
+	stats->min_us    = entry->min_us;
+	stats->max_us    = entry->max_us;
+	stats->mean_us   = sum / entry->count;
+	stats->p95_us    = sorted[(entry->count * 95 + 99) / 100 - 1];
+	stats->uplink_us = entry->uplink_us / entry->uplinks;
+	stats->local_us  = entry->local_us / entry->responses;
+	return 1;
+}
@@ -0,0 +1,111 @@
+/**
+  ******************************************************************************
+  * @file    FramePool.c
+  * @brief   Fixed-block pool of LoRa frame buffers
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * Every frame buffer of the application comes from this pool instead of the
+  * 0x200 bytes newlib heap. Free blocks are kept on a stack of indexes, so
+  * allocating and freeing are O(1) and safe from interrupt context.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FramePool.h"
+
+static uint8_t          blocks[FRAME_POOL_BLOCKS][FRAME_POOL_BLOCK_SIZE] __attribute__((aligned(4)));
+static uint8_t          freeStack[FRAME_POOL_BLOCKS];
+static uint8_t          freeCount = 0;
+static FramePool_stats  stats;
+
+/**
+ * @brief   Initialize the pool with every block free.
+ *
+ * @details Must be called before any allocation, including the DIO0 interrupt.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void FramePool_init() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t i = 0; i < FRAME_POOL_BLOCKS; i++) {
+		freeStack[i] = FRAME_POOL_BLOCKS - 1 - i;
+	}
+	freeCount = FRAME_POOL_BLOCKS;
+	stats.blocks = FRAME_POOL_BLOCKS;
+	stats.inUse = 0;
+	stats.highWater = 0;
+	stats.allocs = 0;
+	stats.failures = 0;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Take a frame buffer from the pool.
+ *
+ * @param   None
+ *
+ * @return  A FRAME_POOL_BLOCK_SIZE bytes buffer, or NULL if every block is in use.
+ */
+uint8_t* FramePool_alloc() {
+	uint8_t* block = NULL;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (freeCount > 0) {
+		block = blocks[freeStack[--freeCount]];
+		stats.allocs++;
+		stats.inUse++;
+		if (stats.inUse > stats.highWater) {
+			stats.highWater = stats.inUse;
+		}
+	} else {
+		stats.failures++;
+	}
+	__set_PRIMASK(primask);
+	return block;
+}
+
+/**
+ * @brief   Give a frame buffer back to the pool.
+ *
+ * @param   block   A buffer returned by FramePool_alloc, or NULL (ignored).
+ *
+ * @return  None
+ */
+void FramePool_free(uint8_t* block) {
+	if (block == NULL) {
+		return;
+	}
+
+	uint32_t index = (uint32_t)(block - &blocks[0][0]) / FRAME_POOL_BLOCK_SIZE;
+	if (index >= FRAME_POOL_BLOCKS || block != blocks[index]) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (freeCount < FRAME_POOL_BLOCKS) {
+		freeStack[freeCount++] = index;
+		stats.inUse--;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Get the pool usage statistics.
+ *
+ * @param   out   Where the statistics are stored.
+ *
+ * @return  None
+ */
+void FramePool_getStats(FramePool_stats* out) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*out = stats;
+	__set_PRIMASK(primask);
+}
@@ -0,0 +1,130 @@
+/**
+  ******************************************************************************
+  * @file    Kiss.c
+  * @brief   KISS framing of raw frames exchanged with the host PC
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * Frames are delimited by FEND; FEND and FESC inside a frame are sent as
+  * FESC TFEND and FESC TFESC. The first byte of every frame is the command
+  * byte. The decoder keeps its state between chunks, so the UART input can be
+  * fed to it in pieces of any size.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Kiss.h"
+
+// worst case: FENDs around a command byte and data that all need escaping
+#define KISS_ENCODED_MAX      (2 * (KISS_MAX_FRAME + 1) + 2)
+
+static uint8_t encoded[KISS_ENCODED_MAX];
+
+/**
+ * @brief   Initialize a stream decoder.
+ *
+ * @param   decoder   The decoder.
+ * @param   onFrame   Called with the command byte and data of every complete frame.
+ *
+ * @return  None
+ */
+void Kiss_init(Kiss_decoder* decoder, Kiss_frameFn onFrame) {
+	decoder->length = 0;
+	decoder->escaped = 0;
+	decoder->overflow = 0;
+	decoder->onFrame = onFrame;
+	decoder->frames = 0;
+	decoder->errors = 0;
+}
+
+/**
+ * @brief   Feed received bytes to the decoder.
+ *
+ * @details Empty frames, as produced by back to back FENDs, are ignored. A frame longer
+ *          than KISS_MAX_FRAME bytes is discarded up to the next FEND.
+ *
+ * @param   decoder   The decoder.
+ * @param   data      Received bytes.
+ * @param   len       Number of bytes.
+ *
+ * @return  None
+ */
+void Kiss_decode(Kiss_decoder* decoder, const uint8_t* data, uint16_t len) {
+	for (uint16_t i = 0; i < len; i++) {
+		uint8_t byte = data[i];
+
+		if (byte == KISS_FEND) {
+			if (decoder->overflow) {
+				decoder->errors++;
+			} else if (decoder->length > 0 && decoder->onFrame != NULL) {
+				decoder->frames++;
+				decoder->onFrame(decoder->buffer[0], &decoder->buffer[1], decoder->length - 1);
+			}
+			decoder->length = 0;
+			decoder->escaped = 0;
+			decoder->overflow = 0;
+			continue;
+		}
+
+		if (decoder->escaped) {
+			decoder->escaped = 0;
+			if (byte == KISS_TFEND) {
+				byte = KISS_FEND;
+			} else if (byte == KISS_TFESC) {
+				byte = KISS_FESC;
+			} else {
+				decoder->overflow = 1;
+			}
+		} else if (byte == KISS_FESC) {
+			decoder->escaped = 1;
+			continue;
+		}
+
+		if (decoder->length >= sizeof(decoder->buffer)) {
+			decoder->overflow = 1;
+		} else if (!decoder->overflow) {
+			decoder->buffer[decoder->length++] = byte;
+		}
+	}
+}
+
+/**
+ * @brief   Encode and send a frame.
+ *
+ * @details The whole frame is encoded first and handed to the writer in a single call, so
+ *          a writer that drops what does not fit drops the frame as a whole; KISS has no
+ *          checksum and the host could not tell a spliced frame from a good one. Not
+ *          reentrant, call it from thread context only.
+ *
+ * @param   command   Command byte, e.g. (KISS_PORT_FRAME << 4) | KISS_CMD_DATA.
+ * @param   data      Frame data, at most KISS_MAX_FRAME bytes.
+ * @param   len       Number of data bytes.
+ * @param   write     Output function.
+ *
+ * @return  The number of bytes written, escapes and delimiters included, 0 if the frame
+ *          was too long or the writer did not take all of it.
+ */
+uint16_t Kiss_encode(uint8_t command, const uint8_t* data, uint16_t len, Kiss_writeFn write) {
+	uint16_t used = 0;
+
+	if (len > KISS_MAX_FRAME) {
+		return 0;
+	}
+	encoded[used++] = KISS_FEND;
+	for (int32_t i = -1; i < (int32_t)len; i++) {
+		uint8_t byte = i < 0 ? command : data[i];
+
+		if (byte == KISS_FEND) {
+			encoded[used++] = KISS_FESC;
+			encoded[used++] = KISS_TFEND;
+		} else if (byte == KISS_FESC) {
+			encoded[used++] = KISS_FESC;
+			encoded[used++] = KISS_TFESC;
+		} else {
+			encoded[used++] = byte;
+		}
+	}
+	encoded[used++] = KISS_FEND;
+	return write(encoded, used) == used ? used : 0;
+}
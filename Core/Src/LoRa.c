@@ -1,4 +1,5 @@
 #include "LoRa.h"
+#include <string.h>
 
 /* ----------------------------------------------------------------------------- *\
 		name        : newLoRa
@@ -16,9 +17,13 @@
 											| 		  coding rate = 4/5            |
 											----------------------------------------
 \* ----------------------------------------------------------------------------- */
+static void LoRa_startTransmit(LoRa* _LoRa);
+static void LoRa_finishReceive(LoRa* _LoRa);
+
 LoRa newLoRa(){
 	LoRa new_LoRa;
 
+	new_LoRa.current_mode          = STNBY_MODE;
 	new_LoRa.frequency             = 433       ;
 	new_LoRa.spredingFactor        = SF_7      ;
 	new_LoRa.bandWidth			   = BW_125KHz ;
@@ -26,9 +31,59 @@ LoRa newLoRa(){
 	new_LoRa.power				   = POWER_20db;
 	new_LoRa.overCurrentProtection = 100       ;
 	new_LoRa.preamble			   = 8         ;
+	new_LoRa.dma_busy			   = 0         ;
+	new_LoRa.dma_callback		   = NULL      ;
+	new_LoRa.DIO0_IRQn			   = DIO0_EXTI_IRQn;
+	new_LoRa.lockDepth			   = 0         ;
+	new_LoRa.txBusy				   = 0         ;
+	new_LoRa.txStatus			   = 0         ;
+	new_LoRa.txDoneCallback		   = NULL      ;
+	new_LoRa.rxCallback			   = NULL      ;
+	LoRa_invalidateShadow(&new_LoRa);
+	memset(&new_LoRa.timing, 0, sizeof(new_LoRa.timing));
+	memset(&new_LoRa.rxMeta, 0, sizeof(new_LoRa.rxMeta));
+	memset(&new_LoRa.rxStats, 0, sizeof(new_LoRa.rxStats));
 
 	return new_LoRa;
 }
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_isShadowed
+
+		description : tell if a register is a configuration register mirrored in the
+									LoRa shadow. Status registers (FiFo pointers, IRQ flags,
+									packet RSSI/SNR...) change on their own and are never cached.
+
+		arguments   :
+			uint8_t address     -->	address of the register e.g 0x1D
+
+		returns     : 1 if the register is shadowed, otherwise 0
+\* ----------------------------------------------------------------------------- */
+static uint8_t LoRa_isShadowed(uint8_t address){
+	switch(address){
+	case RegOpMode:
+	case RegFrMsb:
+	case RegFrMid:
+	case RegFrLsb:
+	case RegPaConfig:
+	case RegPaRamp:
+	case RegOcp:
+	case RegLna:
+	case RegFiFoTxBaseAddr:
+	case RegFiFoRxBaseAddr:
+	case RegModemConfig1:
+	case RegModemConfig2:
+	case RegSymbTimeoutL:
+	case RegPreambleMsb:
+	case RegPreambleLsb:
+	case RegPayloadLength:
+	case RegDioMapping1:
+	case RegDioMapping2:
+		return 1;
+	default:
+		return 0;
+	}
+}
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_reset
 
@@ -40,30 +95,68 @@ LoRa newLoRa(){
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
 void LoRa_reset(LoRa* _LoRa){
+	uint32_t start = get_cycles();
+
 	HAL_GPIO_WritePin(_LoRa->reset_port, _LoRa->reset_pin, GPIO_PIN_RESET);
-	//HAL_Delay(1);
-	//delay_ms(1);
+	delay_us(LORA_RESET_PULSE_US);
 	HAL_GPIO_WritePin(_LoRa->reset_port, _LoRa->reset_pin, GPIO_PIN_SET);
-	//HAL_Delay(100);
-	delay_ms(100);
+	// datasheet: wait 5 ms after releasing NRESET before using the chip
+	delay_ms(LORA_RESET_WAIT_MS);
+	// registers are back to their reset values
+	LoRa_invalidateShadow(_LoRa);
+
+	_LoRa->timing.reset_us = cycles_to_us(get_cycles() - start);
 }
 
 /* ----------------------------------------------------------------------------- *\
-		name        : LoRa_gotoMode
+		name        : LoRa_waitMode
 
-		description : set LoRa Op mode
+		description : wait until RegOpMode reports the requested mode, bounded by
+									LORA_MODE_TIMEOUT_US. Leaving SLEEP also waits for the
+									oscillator start-up time given by the datasheet.
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+			uint8_t  bits     --> expected value of the RegOpMode mode bits
+			int      previous --> mode before the switch
+
+		returns     : 1 if the mode was reached, 0 on timeout
+\* ----------------------------------------------------------------------------- */
+static uint8_t LoRa_waitMode(LoRa* _LoRa, uint8_t bits, int previous){
+	uint32_t start = get_cycles();
+
+	if(previous == SLEEP_MODE && bits != 0x00)
+		delay_us(LORA_OSC_STARTUP_US);
+
+	while((LoRa_read(_LoRa, RegOpMode) & 0x07) != bits){
+		if(cycles_to_us(get_cycles() - start) > LORA_MODE_TIMEOUT_US){
+			_LoRa->timing.modeTimeouts++;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_setMode
+
+		description : request a LoRa Op mode with a single write of RegOpMode, without
+									waiting for the modem to reach it. Used from interrupt
+									context, where the mode is not polled.
 
 		arguments   :
 			LoRa* LoRa    --> LoRa object handler
 			mode	        --> select from defined modes
 
-		returns     : Nothing
+		returns     : the mode bits written to RegOpMode
 \* ----------------------------------------------------------------------------- */
-void LoRa_gotoMode(LoRa* _LoRa, int mode){
+static uint8_t LoRa_setMode(LoRa* _LoRa, int mode){
 	uint8_t    read;
 	uint8_t    data;
+	int        previous = _LoRa->current_mode;
 
-	read = LoRa_read(_LoRa, RegOpMode);
+	// only the upper bits are kept, the mode bits are overwritten below
+	read = LoRa_readCached(_LoRa, RegOpMode);
 	data = read;
 
 	if(mode == SLEEP_MODE){
@@ -84,10 +177,145 @@ void LoRa_gotoMode(LoRa* _LoRa, int mode){
 	}
 
 	LoRa_write(_LoRa, RegOpMode, data);
-	//HAL_Delay(10);
-	delay_ms(10);
+	// the modem restarts its packet counters on every transition into RX
+	if(mode == RXCONTIN_MODE && previous != RXCONTIN_MODE)
+		_LoRa->rxStats.headerCnt = 0;
+	return data & 0x07;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_gotoMode
+
+		description : set LoRa Op mode and wait until the modem reports it
+
+		arguments   :
+			LoRa* LoRa    --> LoRa object handler
+			mode	        --> select from defined modes
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_gotoMode(LoRa* _LoRa, int mode){
+	int        previous = _LoRa->current_mode;
+	uint32_t   start    = get_cycles();
+
+	LoRa_waitMode(_LoRa, LoRa_setMode(_LoRa, mode), previous);
+
+	_LoRa->timing.modeSwitch_us = cycles_to_us(get_cycles() - start);
+	if(_LoRa->timing.modeSwitch_us > _LoRa->timing.modeSwitchMax_us)
+		_LoRa->timing.modeSwitchMax_us = _LoRa->timing.modeSwitch_us;
+}
+
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_spiExchange
+
+		description : full-duplex transfer straight on the SPI data register. The TX
+									FiFo is kept fed while fewer than 3 bytes are in flight, so
+									the 32 bit RX FiFo can never overrun.
+
+		arguments   :
+			SPI_TypeDef* spi  --> SPI peripheral
+			uint8_t* tx       --> bytes to send, NULL sends 0x00
+			uint8_t* rx       --> received bytes, NULL discards them
+			uint16_t length   --> number of bytes
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_spiExchange(SPI_TypeDef* spi, uint8_t* tx, uint8_t* rx, uint16_t length){
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	uint8_t  read;
+
+	if((spi->CR1 & SPI_CR1_SPE) == 0)
+		spi->CR1 |= SPI_CR1_SPE;
+	// drop anything left in the RX FiFo by a transmit-only transfer
+	while(spi->SR & SPI_SR_FRLVL)
+		read = *(__IO uint8_t*)&spi->DR;
+
+	while(received < length){
+		if(sent < length && (sent - received) < 3 && (spi->SR & SPI_SR_TXE)){
+			*(__IO uint8_t*)&spi->DR = (tx != NULL) ? tx[sent] : 0x00;
+			sent++;
+		}
+		if(spi->SR & SPI_SR_RXNE){
+			read = *(__IO uint8_t*)&spi->DR;
+			if(rx != NULL)
+				rx[received] = read;
+			received++;
+		}
+	}
+	while(spi->SR & SPI_SR_BSY)
+		;
+	(void)read;
 }
 
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_spiWrite
+
+		description : send bytes inside the current chip-select window
+
+		arguments   :
+			LoRa* LoRa        --> LoRa object handler
+			uint8_t backend   --> LORA_SPI_BACKEND_HAL or LORA_SPI_BACKEND_REG
+			uint8_t* data     --> bytes to send
+			uint16_t length   --> number of bytes
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_spiWrite(LoRa* _LoRa, uint8_t backend, uint8_t* data, uint16_t length){
+	if(backend == LORA_SPI_BACKEND_REG){
+		LoRa_spiExchange(_LoRa->hSPIx->Instance, data, NULL, length);
+		return;
+	}
+	HAL_SPI_Transmit(_LoRa->hSPIx, data, length, TRANSMIT_TIMEOUT);
+	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
+		;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_spiRead
+
+		description : receive bytes inside the current chip-select window
+
+		arguments   :
+			LoRa* LoRa        --> LoRa object handler
+			uint8_t backend   --> LORA_SPI_BACKEND_HAL or LORA_SPI_BACKEND_REG
+			uint8_t* data     --> received bytes
+			uint16_t length   --> number of bytes
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_spiRead(LoRa* _LoRa, uint8_t backend, uint8_t* data, uint16_t length){
+	if(backend == LORA_SPI_BACKEND_REG){
+		LoRa_spiExchange(_LoRa->hSPIx->Instance, NULL, data, length);
+		return;
+	}
+	HAL_SPI_Receive(_LoRa->hSPIx, data, length, RECEIVE_TIMEOUT);
+	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
+		;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_waitBus
+
+		description : wait until the FiFo burst running on the SPI DMA has finished.
+									Call it with the bus already taken by LoRa_lockBus: DIO0
+									is then masked and no new burst can start between this
+									check and the access that follows. A burst holds the bus
+									from its start until its completion interrupt releases
+									it, so the DIO0 handler never waits here and the DMA
+									interrupt, which preempts every other caller, always ends
+									the wait
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_waitBus(LoRa* _LoRa){
+	while (_LoRa->dma_busy)
+		;
+}
 
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_readReg
@@ -105,14 +333,13 @@ void LoRa_gotoMode(LoRa* _LoRa, int mode){
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
 void LoRa_readReg(LoRa* _LoRa, uint8_t* address, uint16_t r_length, uint8_t* output, uint16_t w_length){
+	LoRa_lockBus(_LoRa);
+	LoRa_waitBus(_LoRa);
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
-	HAL_SPI_Transmit(_LoRa->hSPIx, address, r_length, TRANSMIT_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
-	HAL_SPI_Receive(_LoRa->hSPIx, output, w_length, RECEIVE_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
+	LoRa_spiWrite(_LoRa, LORA_SPI_BACKEND, address, r_length);
+	LoRa_spiRead(_LoRa, LORA_SPI_BACKEND, output, w_length);
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+	LoRa_unlockBus(_LoRa);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -131,14 +358,13 @@ void LoRa_readReg(LoRa* _LoRa, uint8_t* address, uint16_t r_length, uint8_t* out
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
 void LoRa_writeReg(LoRa* _LoRa, uint8_t* address, uint16_t r_length, uint8_t* values, uint16_t w_length){
+	LoRa_lockBus(_LoRa);
+	LoRa_waitBus(_LoRa);
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
-	HAL_SPI_Transmit(_LoRa->hSPIx, address, r_length, TRANSMIT_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
-	HAL_SPI_Transmit(_LoRa->hSPIx, values, w_length, TRANSMIT_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
+	LoRa_spiWrite(_LoRa, LORA_SPI_BACKEND, address, r_length);
+	LoRa_spiWrite(_LoRa, LORA_SPI_BACKEND, values, w_length);
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+	LoRa_unlockBus(_LoRa);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -153,27 +379,15 @@ void LoRa_writeReg(LoRa* _LoRa, uint8_t* address, uint16_t r_length, uint8_t* va
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
 void LoRa_setFrequency(LoRa* _LoRa, int freq){
-	uint8_t  data;
+	uint8_t  data[3];
 	uint32_t F;
 	F = (freq * 524288)>>5;
 
-	// write Msb:
-	data = F >> 16;
-	LoRa_write(_LoRa, RegFrMsb, data);
-	//HAL_Delay(5);
-	delay_ms(5);
-
-	// write Mid:
-	data = F >> 8;
-	LoRa_write(_LoRa, RegFrMid, data);
-	//HAL_Delay(5);
-	delay_ms(5);
-
-	// write Lsb:
-	data = F >> 0;
-	LoRa_write(_LoRa, RegFrLsb, data);
-	//HAL_Delay(5);
-	delay_ms(5);
+	// write Msb, Mid and Lsb in one burst:
+	data[0] = F >> 16;
+	data[1] = F >> 8;
+	data[2] = F >> 0;
+	LoRa_BurstWrite(_LoRa, RegFrMsb, data, 3);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -196,13 +410,9 @@ void LoRa_setSpreadingFactor(LoRa* _LoRa, int SF){
 	if(SF<7)
 		SF = 7;
 
-	read = LoRa_read(_LoRa, RegModemConfig2);
-	//HAL_Delay(10);
-	delay_ms(10);
+	read = LoRa_readCached(_LoRa, RegModemConfig2);
 	data = (SF << 4) + (read & 0x0F);
 	LoRa_write(_LoRa, RegModemConfig2, data);
-	//HAL_Delay(10);
-	delay_ms(10);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -218,8 +428,6 @@ void LoRa_setSpreadingFactor(LoRa* _LoRa, int SF){
 \* ----------------------------------------------------------------------------- */
 void LoRa_setPower(LoRa* _LoRa, uint8_t power){
 	LoRa_write(_LoRa, RegPaConfig, power);
-	//HAL_Delay(10);
-	delay_ms(10);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -233,7 +441,7 @@ void LoRa_setPower(LoRa* _LoRa, uint8_t power){
 
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
-void LoRa_setOCP(LoRa* _LoRa, uint8_t current){
+static uint8_t LoRa_ocpValue(uint8_t current){
 	uint8_t	OcpTrim = 0;
 
 	if(current<45)
@@ -246,10 +454,11 @@ void LoRa_setOCP(LoRa* _LoRa, uint8_t current){
 	else if(current <= 240)
 		OcpTrim = (current + 30)/10;
 
-	OcpTrim = OcpTrim + (1 << 5);
-	LoRa_write(_LoRa, RegOcp, OcpTrim);
-	//HAL_Delay(10);
-	delay_ms(10);
+	return OcpTrim + (1 << 5);
+}
+
+void LoRa_setOCP(LoRa* _LoRa, uint8_t current){
+	LoRa_write(_LoRa, RegOcp, LoRa_ocpValue(current));
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -265,12 +474,10 @@ void LoRa_setOCP(LoRa* _LoRa, uint8_t current){
 void LoRa_setTOMsb_setCRCon(LoRa* _LoRa){
 	uint8_t read, data;
 
-	read = LoRa_read(_LoRa, RegModemConfig2);
+	read = LoRa_readCached(_LoRa, RegModemConfig2);
 
 	data = read | 0x07;
-	LoRa_write(_LoRa, RegModemConfig2, data);\
-	//HAL_Delay(10);
-	delay_ms(10);
+	LoRa_write(_LoRa, RegModemConfig2, data);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -290,8 +497,10 @@ uint8_t LoRa_read(LoRa* _LoRa, uint8_t address){
 
 	data_addr = address & 0x7F;
 	LoRa_readReg(_LoRa, &data_addr, 1, &read_data, 1);
-	//HAL_Delay(5);
-	delay_ms(5);
+	if(LoRa_isShadowed(data_addr)){
+		_LoRa->shadow[data_addr]      = read_data;
+		_LoRa->shadowValid[data_addr] = 1;
+	}
 	return read_data;
 }
 
@@ -314,8 +523,10 @@ void LoRa_write(LoRa* _LoRa, uint8_t address, uint8_t value){
 	addr = address | 0x80;
 	data = value;
 	LoRa_writeReg(_LoRa, &addr, 1, &data, 1);
-	//HAL_Delay(5);
-	delay_ms(5);
+	if(LoRa_isShadowed(address)){
+		_LoRa->shadow[address]      = value;
+		_LoRa->shadowValid[address] = 1;
+	}
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -334,21 +545,303 @@ void LoRa_BurstWrite(LoRa* _LoRa, uint8_t address, uint8_t *value, uint8_t lengt
 	uint8_t addr;
 	addr = address | 0x80;
 
+	LoRa_lockBus(_LoRa);
+	LoRa_waitBus(_LoRa);
+
 	//NSS = 1
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
 
-	HAL_SPI_Transmit(_LoRa->hSPIx, &addr, 1, TRANSMIT_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
+	LoRa_spiWrite(_LoRa, LORA_SPI_BACKEND, &addr, 1);
 	//Write data in FiFo
-	HAL_SPI_Transmit(_LoRa->hSPIx, value, length, TRANSMIT_TIMEOUT);
-	while (HAL_SPI_GetState(_LoRa->hSPIx) != HAL_SPI_STATE_READY)
-		;
+	LoRa_spiWrite(_LoRa, LORA_SPI_BACKEND, value, length);
+	// register bursts auto-increment the address, the FiFo does not
+	if(address != RegFiFo){
+		for(int i=0; i<length; i++){
+			if(LoRa_isShadowed(address + i)){
+				_LoRa->shadow[address + i]      = value[i];
+				_LoRa->shadowValid[address + i] = 1;
+			}
+		}
+	}
 	//NSS = 0
-	//HAL_Delay(5);
-	delay_ms(5);
 	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+	LoRa_unlockBus(_LoRa);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_BurstRead
+
+		description : read a set of values from a register by an address respectively
+									in a single chip-select window (e.g. drain the FiFo)
+
+		arguments   :
+			LoRa*   LoRa        --> LoRa object handler
+			uint8_t address     -->	address of the register e.g RegFiFo
+			uint8_t *value      --> address of the array where values are stored
+			uint8_t length      --> number of bytes to read
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_BurstRead(LoRa* _LoRa, uint8_t address, uint8_t *value, uint8_t length){
+	uint8_t addr;
+	addr = address & 0x7F;
+
+	if(length == 0)
+		return;
+	LoRa_readReg(_LoRa, &addr, 1, value, length);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_lockBus
+
+		description : take ownership of the SPI bus for a sequence of accesses. The
+									DIO0 interrupt is masked while the bus is owned, so its
+									handler can safely talk to the module; an edge arriving
+									meanwhile stays pending and is served on LoRa_unlockBus.
+									Calls can be nested, also from the DIO0 and DMA
+									interrupts, so the depth is updated with interrupts off.
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_lockBus(LoRa* _LoRa){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(_LoRa->lockDepth++ == 0)
+		HAL_NVIC_DisableIRQ(_LoRa->DIO0_IRQn);
+	__set_PRIMASK(primask);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_unlockBus
+
+		description : release the SPI bus taken with LoRa_lockBus
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_unlockBus(LoRa* _LoRa){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(_LoRa->lockDepth > 0 && --_LoRa->lockDepth == 0)
+		HAL_NVIC_EnableIRQ(_LoRa->DIO0_IRQn);
+	__set_PRIMASK(primask);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_readReg_DMA
+
+		description : start a non-blocking burst read of consecutive registers.
+									The address byte is clocked out directly, then the data
+									phase runs on the SPI DMA streams. The CS line is held
+									low until LoRa_DMA_complete is called from the SPI
+									completion callback.
+
+		arguments   :
+			LoRa*         LoRa     --> LoRa object handler
+			uint8_t       address  --> address of the first register e.g RegFiFo
+			uint8_t*      output   --> destination buffer, must stay valid until completion
+			uint16_t      length   --> number of bytes to read
+			LoRa_callback callback --> called from interrupt context when done (or NULL)
+
+		returns     : LORA_OK if the transfer was started, LORA_BUSY if another
+									DMA transfer is in flight, LORA_UNAVAILABLE if HAL refused it
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_readReg_DMA(LoRa* _LoRa, uint8_t address, uint8_t* output, uint16_t length, LoRa_callback callback){
+	uint8_t addr;
+
+	LoRa_lockBus(_LoRa);
+	if(_LoRa->dma_busy){
+		LoRa_unlockBus(_LoRa);
+		return LORA_BUSY;
+	}
+
+	addr = address & 0x7F;
+	_LoRa->dma_busy     = 1;
+	_LoRa->dma_callback = callback;
+
+	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
+	HAL_SPI_Transmit(_LoRa->hSPIx, &addr, 1, TRANSMIT_TIMEOUT);
+	if(HAL_SPI_Receive_DMA(_LoRa->hSPIx, output, length) != HAL_OK){
+		HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+		_LoRa->dma_busy = 0;
+		LoRa_unlockBus(_LoRa);
+		return LORA_UNAVAILABLE;
+	}
+	return LORA_OK;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_writeReg_DMA
+
+		description : start a non-blocking burst write of consecutive registers
+									(e.g. the FIFO). Same bus handling as LoRa_readReg_DMA.
+
+		arguments   :
+			LoRa*         LoRa     --> LoRa object handler
+			uint8_t       address  --> address of the first register e.g RegFiFo
+			uint8_t*      values   --> source buffer, must stay valid until completion
+			uint16_t      length   --> number of bytes to write
+			LoRa_callback callback --> called from interrupt context when done (or NULL)
+
+		returns     : LORA_OK if the transfer was started, LORA_BUSY if another
+									DMA transfer is in flight, LORA_UNAVAILABLE if HAL refused it
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_writeReg_DMA(LoRa* _LoRa, uint8_t address, uint8_t* values, uint16_t length, LoRa_callback callback){
+	uint8_t addr;
+
+	LoRa_lockBus(_LoRa);
+	if(_LoRa->dma_busy){
+		LoRa_unlockBus(_LoRa);
+		return LORA_BUSY;
+	}
+
+	addr = address | 0x80;
+	_LoRa->dma_busy     = 1;
+	_LoRa->dma_callback = callback;
+
+	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
+	HAL_SPI_Transmit(_LoRa->hSPIx, &addr, 1, TRANSMIT_TIMEOUT);
+	if(HAL_SPI_Transmit_DMA(_LoRa->hSPIx, values, length) != HAL_OK){
+		HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+		_LoRa->dma_busy = 0;
+		LoRa_unlockBus(_LoRa);
+		return LORA_UNAVAILABLE;
+	}
+	return LORA_OK;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_isBusy
+
+		description : check if a DMA transfer is still in flight
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : 1 while the bus is owned by a DMA transfer, otherwise 0
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_isBusy(LoRa* _LoRa){
+	return _LoRa->dma_busy;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_DMA_complete
+
+		description : finish the current DMA transfer: release CS, free the bus and
+									run the user callback. Call it from the HAL SPI Tx
+									complete, Rx complete and error callbacks of the SPI
+									used by LoRa.
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_DMA_complete(LoRa* _LoRa){
+	LoRa_callback callback;
+
+	if(!_LoRa->dma_busy)
+		return;
+
+	HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+	callback            = _LoRa->dma_callback;
+	_LoRa->dma_callback = NULL;
+	_LoRa->dma_busy     = 0;
+	LoRa_unlockBus(_LoRa);
+
+	if(callback != NULL)
+		callback(_LoRa);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_readCached
+
+		description : read a register, serving shadowed configuration registers from
+									RAM when their value is known. Other registers are read
+									from the module.
+
+		arguments   :
+			LoRa*   LoRa        --> LoRa object handler
+			uint8_t address     -->	address of the register e.g 0x1D
+
+		returns     : register value
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_readCached(LoRa* _LoRa, uint8_t address){
+	if(LoRa_isShadowed(address) && _LoRa->shadowValid[address])
+		return _LoRa->shadow[address];
+	return LoRa_read(_LoRa, address);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_invalidateShadow
+
+		description : forget every shadowed value, next accesses go to the module
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_invalidateShadow(LoRa* _LoRa){
+	for(int i=0; i<LORA_SHADOW_SIZE; i++)
+		_LoRa->shadowValid[i] = 0;
 }
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_resync
+
+		description : reload the whole shadow from the module
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_resync(LoRa* _LoRa){
+	LoRa_invalidateShadow(_LoRa);
+	for(int i=0; i<LORA_SHADOW_SIZE; i++){
+		if(LoRa_isShadowed(i))
+			LoRa_read(_LoRa, i);
+	}
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_verify
+
+		description : compare every valid shadowed register against the module,
+									read back in a single SPI burst. The mode bits of RegOpMode
+									are ignored because the module changes them on its own
+									(e.g. TX -> STNBY after TxDone).
+									The shadow is left untouched, call LoRa_resync to adopt
+									the module values.
+
+		arguments   :
+			LoRa* LoRa --> LoRa object handler
+
+		returns     : LORA_OK if shadow and module agree, otherwise LORA_MISMATCH
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_verify(LoRa* _LoRa){
+	uint8_t regs[LORA_SHADOW_SIZE];
+	uint8_t mask;
+
+	// one burst covers every shadowed register (RegOpMode..RegDioMapping2)
+	LoRa_BurstRead(_LoRa, RegOpMode, &regs[RegOpMode], LORA_SHADOW_SIZE - RegOpMode);
+
+	for(int i=RegOpMode; i<LORA_SHADOW_SIZE; i++){
+		if(!LoRa_isShadowed(i) || !_LoRa->shadowValid[i])
+			continue;
+		mask = (i == RegOpMode) ? 0xF8 : 0xFF;
+		if((regs[i] & mask) != (_LoRa->shadow[i] & mask))
+			return LORA_MISMATCH;
+	}
+	return LORA_OK;
+}
+
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_isvalid
 
@@ -377,35 +870,245 @@ uint8_t LoRa_isvalid(LoRa* _LoRa){
 		returns     : 1 in case of success, 0 in case of timeout
 \* ----------------------------------------------------------------------------- */
 uint8_t LoRa_transmit(LoRa* _LoRa, uint8_t* data, uint8_t length, uint16_t timeout){
-	uint8_t read;
-	int mode = _LoRa->current_mode;
+	uint8_t  read;
+	int      mode  = _LoRa->current_mode;
+	uint32_t start = get_cycles();
+	uint32_t txStart;
+	uint32_t txDone;
+	uint32_t tickStart;
+
 	LoRa_gotoMode(_LoRa, STNBY_MODE);
-	read = LoRa_read(_LoRa, RegFiFoTxBaseAddr);
+	read = LoRa_readCached(_LoRa, RegFiFoTxBaseAddr);
 	LoRa_write(_LoRa, RegFiFoAddPtr, read);
 	LoRa_write(_LoRa, RegPayloadLength, length);
 	LoRa_BurstWrite(_LoRa, RegFiFo, data, length);
 	LoRa_gotoMode(_LoRa, TRANSMIT_MODE);
+	txStart = get_cycles();
+	_LoRa->timing.txLoad_us = cycles_to_us(txStart - start);
+
+	// poll TxDone, bounded by the timeout in milliseconds
+	tickStart = HAL_GetTick();
 	while(1){
 		read = LoRa_read(_LoRa, RegIrqFlags);
 		if((read & 0x08)!=0){
+			txDone = get_cycles();
+			_LoRa->timing.txAir_us = cycles_to_us(txDone - txStart);
 			LoRa_write(_LoRa, RegIrqFlags, 0xFF);
 			LoRa_gotoMode(_LoRa, mode);
+			_LoRa->timing.txTurnaround_us = cycles_to_us(get_cycles() - txDone);
 			return 1;
 		}
-		else{
-			if(--timeout==0){
-				LoRa_gotoMode(_LoRa, mode);
-				return 0;
-			}
+		else if((HAL_GetTick() - tickStart) >= timeout){
+			LoRa_gotoMode(_LoRa, mode);
+			return 0;
 		}
-		delay_ms(1);
 	}
 }
 
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_transmit_IT
+
+		description : Start a transmission and return immediately. The payload is
+									loaded into the FiFo by the SPI DMA; its completion
+									interrupt remaps DIO0 to TxDone and starts the TX mode.
+									LoRa_onDIO0 completes the transmission from the EXTI
+									callback, maps DIO0 back to RxDone and returns to RX
+									continuous mode. The driver has no timeout of its own:
+									the caller bounds the transmission with a timer and
+									ends it with LoRa_abortTransmit.
+
+		arguments   :
+			LoRa*         LoRa     --> LoRa object handler
+			uint8_t       data     --> A pointer to the data you wanna send, it must
+															 stay valid until the callback runs
+			uint8_t	      length   --> Size of your data in Bytes
+			LoRa_callback callback --> called when the transmission ends (or NULL),
+															 txStatus is 1 in case of success, 0 if aborted
+		returns     : LORA_OK if the transmission started, LORA_BUSY if the previous
+									one is still on air
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_transmit_IT(LoRa* _LoRa, uint8_t* data, uint8_t length, LoRa_callback callback){
+	uint8_t  read;
+
+	if(_LoRa->txBusy)
+		return LORA_BUSY;
+
+	LoRa_lockBus(_LoRa);
+	_LoRa->txStart        = get_cycles();
+	_LoRa->txReturnMode   = RXCONTIN_MODE;
+	_LoRa->txDoneCallback = callback;
+	_LoRa->txStatus       = 0;
+	_LoRa->txBusy         = 1;
+	LoRa_gotoMode(_LoRa, STNBY_MODE);
+	read = LoRa_readCached(_LoRa, RegFiFoTxBaseAddr);
+	LoRa_write(_LoRa, RegFiFoAddPtr, read);
+	LoRa_write(_LoRa, RegPayloadLength, length);
+	if(LoRa_writeReg_DMA(_LoRa, RegFiFo, data, length, LoRa_startTransmit) != LORA_OK){
+		LoRa_BurstWrite(_LoRa, RegFiFo, data, length);
+		LoRa_startTransmit(_LoRa);
+	}
+	LoRa_unlockBus(_LoRa);
+
+	return LORA_OK;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_startTransmit
+
+		description : second half of LoRa_transmit_IT, run once the payload is in the
+									FiFo, from the SPI DMA completion interrupt: map DIO0 to
+									TxDone and request the TX mode, without polling it
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_startTransmit(LoRa* _LoRa){
+	uint8_t  read;
+	uint32_t start = _LoRa->txStart;
+
+	LoRa_lockBus(_LoRa);
+	// DIO mapping:   --> DIO0: TxDone
+	read = LoRa_readCached(_LoRa, RegDioMapping1);
+	LoRa_write(_LoRa, RegDioMapping1, (read & 0x3F) | 0x40);
+	// a RxDone edge latched while DIO0 was masked is stale now; the RxDone flag stays
+	// set and raises DIO0 again when it is mapped back after the transmission
+	__HAL_GPIO_EXTI_CLEAR_IT(_LoRa->DIO0_pin);
+	HAL_NVIC_ClearPendingIRQ(_LoRa->DIO0_IRQn);
+	LoRa_setMode(_LoRa, TRANSMIT_MODE);
+	_LoRa->txStart = get_cycles();
+	_LoRa->timing.txLoad_us = cycles_to_us(_LoRa->txStart - start);
+	LoRa_unlockBus(_LoRa);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_finishTransmit
+
+		description : end the asynchronous transmission: clear TxDone, map DIO0 back
+									to RxDone, request the receive mode and run the callback.
+									Runs from the DIO0 interrupt, so the mode is not polled.
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+			uint8_t  status   --> 1 for TxDone, 0 if aborted
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_finishTransmit(LoRa* _LoRa, uint8_t status){
+	uint8_t       read;
+	uint32_t      txDone = get_cycles();
+	LoRa_callback callback;
+
+	LoRa_lockBus(_LoRa);
+	if(status)
+		_LoRa->timing.txAir_us = cycles_to_us(txDone - _LoRa->txStart);
+	LoRa_write(_LoRa, RegIrqFlags, 0x08);
+
+	// DIO mapping:   --> DIO0: RxDone, a packet received before the transmission
+	// started still has RxDone set and raises DIO0 again here
+	read = LoRa_readCached(_LoRa, RegDioMapping1);
+	LoRa_write(_LoRa, RegDioMapping1, read & 0x3F);
+	LoRa_setMode(_LoRa, _LoRa->txReturnMode);
+	_LoRa->timing.txTurnaround_us = cycles_to_us(get_cycles() - txDone);
+
+	callback              = _LoRa->txDoneCallback;
+	_LoRa->txDoneCallback = NULL;
+	_LoRa->txStatus       = status;
+	_LoRa->txBusy         = 0;
+	LoRa_unlockBus(_LoRa);
+
+	if(callback != NULL)
+		callback(_LoRa);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_isTransmitting
+
+		description : check if an asynchronous transmission is on air
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : 1 while transmitting, otherwise 0
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_isTransmitting(LoRa* _LoRa){
+	return _LoRa->txBusy;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_abortTransmit
+
+		description : stop the asynchronous transmission on air, if any. The radio
+									goes back to the return mode and the callback runs with
+									txStatus 0. Call it when the transmission timeout expires
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_abortTransmit(LoRa* _LoRa){
+	LoRa_lockBus(_LoRa);
+	if(_LoRa->txBusy)
+		LoRa_finishTransmit(_LoRa, 0);
+	LoRa_unlockBus(_LoRa);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_isReceiving
+
+		description : check in RegModemStat if the modem is in the middle of a
+									reception (preamble detected, synchronized or header
+									received), so a transmission now would destroy it
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : 1 while a packet is being received, otherwise 0
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_isReceiving(LoRa* _LoRa){
+	if(_LoRa->current_mode != RXCONTIN_MODE && _LoRa->current_mode != RXSINGLE_MODE)
+		return 0;
+	return (LoRa_read(_LoRa, RegModemStat) & LORA_MODEM_RX_BUSY) != 0;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_onDIO0
+
+		description : DIO0 handler, call it from HAL_GPIO_EXTI_Callback. While
+									transmitting RegIrqFlags tells a TxDone edge, which
+									completes the asynchronous transmission in place, from a
+									stale one, which is ignored: the radio must not leave TX
+									to read a packet, its RxDone flag raises DIO0 again when
+									the transmission ends. Otherwise the edge is a RxDone and
+									is timestamped for the packet metadata.
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : LORA_IRQ_TXDONE if the edge ended a transmission, LORA_IRQ_NONE
+									for a stale edge during a transmission, otherwise
+									LORA_IRQ_RXDONE (a packet is waiting in the FiFo)
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_onDIO0(LoRa* _LoRa){
+	if(_LoRa->txBusy){
+		if((LoRa_read(_LoRa, RegIrqFlags) & 0x08) == 0)
+			return LORA_IRQ_NONE;
+		LoRa_finishTransmit(_LoRa, 1);
+		return LORA_IRQ_TXDONE;
+	}
+	// timestamp the packet for its metadata record
+	_LoRa->rxCycles = get_cycles();
+	_LoRa->rxTick   = HAL_GetTick();
+	return LORA_IRQ_RXDONE;
+}
+
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_startReceiving
 
-		description : Start receiving continuously
+		description : Start receiving continuously, nothing is done if the modem
+									is already in RX continuous mode
 
 		arguments   :
 			LoRa*    LoRa     --> LoRa object handler
@@ -413,42 +1116,223 @@ uint8_t LoRa_transmit(LoRa* _LoRa, uint8_t* data, uint8_t length, uint16_t timeo
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
 void LoRa_startReceiving(LoRa* _LoRa){
-	LoRa_gotoMode(_LoRa, RXCONTIN_MODE);
+	if(_LoRa->current_mode != RXCONTIN_MODE)
+		LoRa_gotoMode(_LoRa, RXCONTIN_MODE);
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_parseRxMeta
+
+		description : fill the rxMeta record from the packet status registers
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+			uint8_t  status   --> RegFiFoRxCurrentAddr..RegModemConfig1 burst
+			uint8_t  fei      --> RegFeiMsb..RegFeiLsb burst
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_parseRxMeta(LoRa* _LoRa, uint8_t* status, uint8_t* fei){
+	// bandwidth in Hz, indexed by BW_xxx
+	static const uint32_t bandwidth[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+	LoRa_rxMeta* meta = &_LoRa->rxMeta;
+	int32_t      raw;
+
+	meta->irqFlags    = status[RegIrqFlags - LORA_RXMETA_FIRST];
+	meta->length      = status[RegRxNbBytes - LORA_RXMETA_FIRST];
+	meta->crcError    = (meta->irqFlags & 0x20) != 0;
+	meta->headerValid = (meta->irqFlags & 0x10) != 0;
+	meta->crcOn       = (status[RegHopChannel - LORA_RXMETA_FIRST] & 0x40) != 0;
+	meta->snr         = (int8_t)status[RegPktSnrValue - LORA_RXMETA_FIRST];
+	meta->rssi        = LORA_RSSI_OFFSET + status[RegPktRssiValue - LORA_RXMETA_FIRST];
+	// below the noise floor the packet RSSI has to be corrected with the SNR
+	if(meta->snr < 0)
+		meta->rssi += meta->snr / 4;
+
+	// FEI is a 20 bit two's complement value: Ferr = FEI * 2^24 / Fxtal * BW / 500 kHz
+	raw = ((int32_t)(fei[0] & 0x0F) << 16) | ((int32_t)fei[1] << 8) | fei[2];
+	if(raw & 0x80000)
+		raw -= 0x100000;
+	meta->fei    = (int32_t)(((int64_t)raw * (1 << 24) * bandwidth[_LoRa->bandWidth]) / (32000000LL * 500000LL));
+
+	meta->tick   = _LoRa->rxTick;
+	meta->cycles = _LoRa->rxCycles;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_startReceive
+
+		description : service a RxDone: read the packet status in one burst, then copy
+									the packet from the FiFo. With a callback the FiFo burst
+									runs on the SPI DMA and LoRa_finishReceive completes the
+									read from its completion interrupt; without one, or if
+									the DMA is not available, it is read in place. It runs
+									from the DIO0 interrupt, so the mode changes are single
+									RegOpMode writes that are not polled.
+
+		arguments   :
+			LoRa*         LoRa       --> LoRa object handler
+			uint8_t       data       --> A pointer to the array that you want to write
+																 bytes in it, must stay valid until the callback
+			uint8_t	      length     --> Size of that array, at most this many bytes are read
+			uint8_t       continuous --> 1 to keep the modem in RX continuous mode,
+																 0 to read it in STNBY
+			LoRa_callback callback   --> called when the packet has been read (or NULL)
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_startReceive(LoRa* _LoRa, uint8_t* data, uint8_t length, uint8_t continuous, LoRa_callback callback){
+	uint8_t* status = _LoRa->rxStatus;
+	uint8_t  number_of_bytes;
+
+	_LoRa->rxStart      = get_cycles();
+	_LoRa->rxContinuous = continuous;
+	_LoRa->rxCallback   = callback;
+	_LoRa->rxLength     = 0;
+
+	if(continuous){
+		if(_LoRa->current_mode != RXCONTIN_MODE)
+			LoRa_setMode(_LoRa, RXCONTIN_MODE);
+	}else{
+		// the modem counts no headers in STNBY: a frame already being received when
+		// it leaves RX is cut short, so count it here while RegModemStat still shows it
+		if(LoRa_read(_LoRa, RegModemStat) & LORA_MODEM_RX_BUSY)
+			_LoRa->rxStats.lost++;
+		LoRa_setMode(_LoRa, STNBY_MODE);
+	}
+	LoRa_BurstRead(_LoRa, LORA_RXMETA_FIRST, status, LORA_RXMETA_SIZE);
+	if((status[RegIrqFlags - LORA_RXMETA_FIRST] & 0x40) == 0){
+		LoRa_finishReceive(_LoRa);
+		return;
+	}
+
+	// clear RxDone, PayloadCrcError and ValidHeader only
+	LoRa_write(_LoRa, RegIrqFlags, 0x70);
+	number_of_bytes = status[RegRxNbBytes - LORA_RXMETA_FIRST];
+	LoRa_write(_LoRa, RegFiFoAddPtr, status[RegFiFoRxCurrentAddr - LORA_RXMETA_FIRST]);
+	_LoRa->rxLength = length >= number_of_bytes ? number_of_bytes : length;
+	_LoRa->rxPacket = 1;
+
+	if(callback == NULL || _LoRa->rxLength == 0 ||
+			LoRa_readReg_DMA(_LoRa, RegFiFo, data, _LoRa->rxLength, LoRa_finishReceive) != LORA_OK){
+		LoRa_BurstRead(_LoRa, RegFiFo, data, _LoRa->rxLength);
+		LoRa_finishReceive(_LoRa);
+	}
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_finishReceive
+
+		description : second half of LoRa_startReceive, once the payload has been
+									copied: read the frequency error, fill rxMeta, update the
+									rx statistics, request RX continuous again (not polled)
+									and run the callback
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+static void LoRa_finishReceive(LoRa* _LoRa){
+	uint8_t*      status = _LoRa->rxStatus;
+	uint8_t       fei[3];
+	uint16_t      headers;
+	LoRa_callback callback;
+
+	if(_LoRa->rxPacket){
+		_LoRa->rxPacket = 0;
+		LoRa_BurstRead(_LoRa, RegFeiMsb, fei, 3);
+		LoRa_parseRxMeta(_LoRa, status, fei);
+
+		// every header the modem saw and was not read here is a lost frame
+		headers = (status[RegRxHeaderCntValueMsb - LORA_RXMETA_FIRST] << 8) | status[RegRxHeaderCntValueLsb - LORA_RXMETA_FIRST];
+		if((uint16_t)(headers - _LoRa->rxStats.headerCnt) > 1)
+			_LoRa->rxStats.lost += (uint16_t)(headers - _LoRa->rxStats.headerCnt) - 1;
+		_LoRa->rxStats.headerCnt = headers;
+		_LoRa->rxStats.frames++;
+	}
+
+	if(!_LoRa->rxContinuous)
+		LoRa_setMode(_LoRa, RXCONTIN_MODE);
+	_LoRa->timing.rxRead_us = cycles_to_us(get_cycles() - _LoRa->rxStart);
+	if(!_LoRa->rxContinuous)
+		_LoRa->rxStats.deaf_us += _LoRa->timing.rxRead_us;
+
+	callback           = _LoRa->rxCallback;
+	_LoRa->rxCallback  = NULL;
+	if(callback != NULL)
+		callback(_LoRa);
 }
 
 /* ----------------------------------------------------------------------------- *\
 		name        : LoRa_Receive
 
-		description : Read received data from module
+		description : Read received data from module. The modem is put in STNBY
+									while the FiFo is read and back in RX continuous after, so
+									frames starting meanwhile are lost. A frame already under
+									way when RX is left is counted in rxStats.lost; one that
+									starts and ends while in STNBY is not seen at all, its
+									exposure is rxStats.deaf_us.
+									Only the RegRxNbBytes bytes of the packet are copied; pass a
+									LORA_MAX_PAYLOAD buffer to never truncate a frame. The packet
+									status (RegFiFoRxCurrentAddr up to RegModemConfig1) is read in
+									one burst and, with the frequency error, kept in the rxMeta
+									record of the handler.
 
 		arguments   :
 			LoRa*    LoRa     --> LoRa object handler
 			uint8_t  data			--> A pointer to the array that you want to write bytes in it
-			uint8_t	 length   --> Determines how many bytes you want to read
+			uint8_t	 length   --> Size of that array, at most this many bytes are read
 
 		returns     : The number of bytes received
 \* ----------------------------------------------------------------------------- */
 uint8_t LoRa_receive(LoRa* _LoRa, uint8_t* data, uint8_t length){
-	uint8_t read;
-	uint8_t number_of_bytes;
-	uint8_t min = 0;
+	LoRa_startReceive(_LoRa, data, length, 0, NULL);
+	return _LoRa->rxLength;
+}
 
-	for(int i=0; i<length; i++)
-		data[i]=0;
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_receiveContinuous
 
-	LoRa_gotoMode(_LoRa, STNBY_MODE);
-	read = LoRa_read(_LoRa, RegIrqFlags);
-	if((read & 0x40) != 0){
-		LoRa_write(_LoRa, RegIrqFlags, 0xFF);
-		number_of_bytes = LoRa_read(_LoRa, RegRxNbBytes);
-		read = LoRa_read(_LoRa, RegFiFoRxCurrentAddr);
-		LoRa_write(_LoRa, RegFiFoAddPtr, read);
-		min = length >= number_of_bytes ? number_of_bytes : length;
-		for(int i=0; i<min; i++)
-			data[i] = LoRa_read(_LoRa, RegFiFo);
-	}
-	LoRa_gotoMode(_LoRa, RXCONTIN_MODE);
-	return min;
+		description : Read received data without leaving RX continuous mode. The
+									packet is located with RegFiFoRxCurrentAddr/RegRxNbBytes while
+									the modem keeps listening, so there is no turnaround window.
+									Same packet status and rxMeta handling as LoRa_receive.
+
+		arguments   :
+			LoRa*    LoRa     --> LoRa object handler
+			uint8_t  data			--> A pointer to the array that you want to write bytes in it
+			uint8_t	 length   --> Size of that array, at most this many bytes are read
+
+		returns     : The number of bytes received
+\* ----------------------------------------------------------------------------- */
+uint8_t LoRa_receiveContinuous(LoRa* _LoRa, uint8_t* data, uint8_t length){
+	LoRa_startReceive(_LoRa, data, length, 1, NULL);
+	return _LoRa->rxLength;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_receive_DMA
+
+		description : Same as LoRa_receive or LoRa_receiveContinuous, but the FiFo is
+									copied by the SPI DMA, so the DIO0 handler returns as soon
+									as the burst is started. The callback runs from the DMA
+									completion interrupt, or before returning when there is
+									nothing to copy; the length is in rxLength and the
+									metadata in rxMeta. DIO0 stays masked until then.
+
+		arguments   :
+			LoRa*         LoRa       --> LoRa object handler
+			uint8_t       data       --> A pointer to the array that you want to write
+																 bytes in it, must stay valid until the callback
+			uint8_t	      length     --> Size of that array, at most this many bytes are read
+			uint8_t       continuous --> 1 to keep the modem in RX continuous mode
+			LoRa_callback callback   --> called when the packet has been read
+
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_receive_DMA(LoRa* _LoRa, uint8_t* data, uint8_t length, uint8_t continuous, LoRa_callback callback){
+	LoRa_startReceive(_LoRa, data, length, continuous, callback);
 }
 
 /* ----------------------------------------------------------------------------- *\
@@ -464,85 +1348,231 @@ uint8_t LoRa_receive(LoRa* _LoRa, uint8_t* data, uint8_t length){
 int LoRa_getRSSI(LoRa* _LoRa){
 	uint8_t read;
 	read = LoRa_read(_LoRa, RegPktRssiValue);
-	return -164 + read;
+	return LORA_RSSI_OFFSET + read;
 }
 
 /* ----------------------------------------------------------------------------- *\
-		name        : LoRa_init
+		name        : LoRa_getRxMeta
 
-		description : initialize and set the right setting according to LoRa sruct vars
+		description : get the metadata of the last packet read with LoRa_receive
 
 		arguments   :
 			LoRa* LoRa        --> LoRa object handler
 
+		returns     : A pointer to the rxMeta record of the handler
+\* ----------------------------------------------------------------------------- */
+LoRa_rxMeta* LoRa_getRxMeta(LoRa* _LoRa){
+	return &_LoRa->rxMeta;
+}
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_benchmark
+
+		description : measure the average cost, in CPU cycles, of a single register
+									read (RegVersion) and write (RegFiFoAddPtr) with both SPI
+									backends, chip-select handling included
+
+		arguments   :
+			LoRa*         LoRa       --> LoRa object handler
+			uint32_t      iterations --> accesses to average per measurement
+			LoRa_spiBench result     --> where the measurements are stored
+
 		returns     : Nothing
 \* ----------------------------------------------------------------------------- */
-uint16_t LoRa_init(LoRa* _LoRa){
-	uint8_t    data;
-	uint8_t    read;
+void LoRa_benchmark(LoRa* _LoRa, uint32_t iterations, LoRa_spiBench* result){
+	uint8_t  backends[2] = {LORA_SPI_BACKEND_HAL, LORA_SPI_BACKEND_REG};
+	uint32_t read_cycles[2];
+	uint32_t write_cycles[2];
+	uint8_t  addr;
+	uint8_t  data;
+	uint32_t start;
+
+	if(iterations == 0)
+		iterations = 1;
+
+	LoRa_lockBus(_LoRa);
+	LoRa_waitBus(_LoRa);
+	for(int b=0; b<2; b++){
+		start = get_cycles();
+		for(uint32_t i=0; i<iterations; i++){
+			addr = RegVersion;
+			HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
+			LoRa_spiWrite(_LoRa, backends[b], &addr, 1);
+			LoRa_spiRead(_LoRa, backends[b], &data, 1);
+			HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+		}
+		read_cycles[b] = (get_cycles() - start) / iterations;
+
+		start = get_cycles();
+		for(uint32_t i=0; i<iterations; i++){
+			addr = RegFiFoAddPtr | 0x80;
+			data = 0x00;
+			HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_RESET);
+			LoRa_spiWrite(_LoRa, backends[b], &addr, 1);
+			LoRa_spiWrite(_LoRa, backends[b], &data, 1);
+			HAL_GPIO_WritePin(_LoRa->CS_port, _LoRa->CS_pin, GPIO_PIN_SET);
+		}
+		write_cycles[b] = (get_cycles() - start) / iterations;
+	}
+	LoRa_unlockBus(_LoRa);
 
-	if(LoRa_isvalid(_LoRa)){
-		// goto sleep mode:
-		LoRa_gotoMode(_LoRa, SLEEP_MODE);
-		//HAL_Delay(10);
-		delay_ms(10);
-		// turn on LoRa mode:
-		read = LoRa_read(_LoRa, RegOpMode);
-		//HAL_Delay(10);
-		delay_ms(10);
-		data = read | 0x80;
-		LoRa_write(_LoRa, RegOpMode, data);
-		//HAL_Delay(100);
-		delay_ms(100);
+	result->iterations      = iterations;
+	result->halRead_cycles  = read_cycles[0];
+	result->regRead_cycles  = read_cycles[1];
+	result->halWrite_cycles = write_cycles[0];
+	result->regWrite_cycles = write_cycles[1];
+}
 
-		// set frequency:
-		LoRa_setFrequency(_LoRa, _LoRa->frequency);
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_buildConfig
 
-		// set output power gain:
-		LoRa_setPower(_LoRa, _LoRa->power);
+		description : fill the modem configuration table from the LoRa struct vars.
+									Entries are kept in ascending address order so that
+									consecutive registers can be written in one burst.
 
-		// set over current protection:
-		LoRa_setOCP(_LoRa, _LoRa->overCurrentProtection);
+		arguments   :
+			LoRa*          LoRa   --> LoRa object handler
+			LoRa_regValue* table  --> output table, LORA_CONFIG_SIZE entries
 
-		// set LNA gain:
-		LoRa_write(_LoRa, RegLna, 0x23);
+		returns     : number of entries in the table
+\* ----------------------------------------------------------------------------- */
+static uint8_t LoRa_buildConfig(LoRa* _LoRa, LoRa_regValue* table){
+	uint32_t F  = (_LoRa->frequency * 524288)>>5;
+	uint8_t  SF = _LoRa->spredingFactor;
+	uint8_t  n  = 0;
 
-		// set spreading factor, CRC on, and Timeout Msb:
-		LoRa_setTOMsb_setCRCon(_LoRa);
-		LoRa_setSpreadingFactor(_LoRa, _LoRa->spredingFactor);
+	if(SF>12)
+		SF = 12;
+	if(SF<7)
+		SF = 7;
+
+	// carrier frequency:
+	table[n++] = (LoRa_regValue){RegFrMsb,         F >> 16};
+	table[n++] = (LoRa_regValue){RegFrMid,         F >> 8};
+	table[n++] = (LoRa_regValue){RegFrLsb,         F >> 0};
+	// output power gain:
+	table[n++] = (LoRa_regValue){RegPaConfig,      _LoRa->power};
+	// PA ramp at its reset value (40 us), keeps RegFrMsb..RegLna in one burst:
+	table[n++] = (LoRa_regValue){RegPaRamp,        0x09};
+	// over current protection and LNA gain:
+	table[n++] = (LoRa_regValue){RegOcp,           LoRa_ocpValue(_LoRa->overCurrentProtection)};
+	table[n++] = (LoRa_regValue){RegLna,           0x23};
+	// 8 bit RegModemConfig1 --> |   bandwidth   |     CR    |I/E|
+	table[n++] = (LoRa_regValue){RegModemConfig1,  (_LoRa->bandWidth << 4) + (_LoRa->crcRate << 1)};
+	// 8 bit RegModemConfig2 --> |      SF       |TX |CRC| TO Msb|
+	table[n++] = (LoRa_regValue){RegModemConfig2,  (SF << 4) | 0x07};
+	// Timeout Lsb and preamble:
+	table[n++] = (LoRa_regValue){RegSymbTimeoutL,  0xFF};
+	table[n++] = (LoRa_regValue){RegPreambleMsb,   _LoRa->preamble >> 8};
+	table[n++] = (LoRa_regValue){RegPreambleLsb,   _LoRa->preamble >> 0};
+	// DIO mapping --> DIO0: RxDone
+	table[n++] = (LoRa_regValue){RegDioMapping1,   0x3F};
+
+	return n;
+}
 
-		// set Timeout Lsb:
-		LoRa_write(_LoRa, RegSymbTimeoutL, 0xFF);
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_writeTable
+
+		description : write a (register, value) table. Runs of consecutive addresses
+									are sent as a single SPI burst.
+
+		arguments   :
+			LoRa*                LoRa   --> LoRa object handler
+			const LoRa_regValue* table  --> table sorted by ascending address
+			uint8_t              count  --> number of entries
 
-		// set bandwidth, coding rate and expilicit mode:
-		// 8 bit RegModemConfig --> | X | X | X | X | X | X | X | X |
-		//       bits represent --> |   bandwidth   |     CR    |I/E|
-		data = 0;
-		data = (_LoRa->bandWidth << 4) + (_LoRa->crcRate << 1);
-		LoRa_write(_LoRa, RegModemConfig1, data);
+		returns     : Nothing
+\* ----------------------------------------------------------------------------- */
+void LoRa_writeTable(LoRa* _LoRa, const LoRa_regValue* table, uint8_t count){
+	uint8_t values[LORA_CONFIG_SIZE];
+	uint8_t first = 0;
+	uint8_t run;
+
+	while(first < count){
+		run = 0;
+		do{
+			values[run] = table[first + run].value;
+			run++;
+		}while(first + run < count && run < LORA_CONFIG_SIZE &&
+				table[first + run].address == table[first].address + run);
+
+		LoRa_BurstWrite(_LoRa, table[first].address, values, run);
+		first += run;
+	}
+}
 
-		// set preamble:
-		LoRa_write(_LoRa, RegPreambleMsb, _LoRa->preamble >> 8);
-		LoRa_write(_LoRa, RegPreambleLsb, _LoRa->preamble >> 0);
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_init
 
-		// DIO mapping:   --> DIO: RxDone
-		read = LoRa_read(_LoRa, RegDioMapping1);
-		data = read | 0x3F;
-		LoRa_write(_LoRa, RegDioMapping1, data);
+		description : initialize and set the right setting according to LoRa sruct vars.
+									The configuration is built as a register table, written in
+									bursts and checked with a single readback at the end.
+
+		arguments   :
+			LoRa* LoRa        --> LoRa object handler
+
+		returns     : LORA_OK, LORA_NOT_FOUND if no SX127x answers, LORA_MISMATCH if
+									the readback differs, LORA_UNAVAILABLE for invalid settings
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_init(LoRa* _LoRa){
+	LoRa_regValue config[LORA_CONFIG_SIZE];
+	uint8_t       count;
+	uint8_t       data;
+	uint8_t       read;
+	uint16_t      status;
+	uint32_t      start = get_cycles();
+
+	if(LoRa_isvalid(_LoRa)){
+		read = LoRa_read(_LoRa, RegVersion);
+		if(read != 0x12)
+			return LORA_NOT_FOUND;
+
+		// goto sleep mode:
+		LoRa_gotoMode(_LoRa, SLEEP_MODE);
+		// turn on LoRa mode (only allowed in sleep mode):
+		read = LoRa_readCached(_LoRa, RegOpMode);
+		data = read | 0x80;
+		LoRa_write(_LoRa, RegOpMode, data);
+
+		// modem configuration:
+		count = LoRa_buildConfig(_LoRa, config);
+		LoRa_writeTable(_LoRa, config, count);
 
 		// goto standby mode:
 		LoRa_gotoMode(_LoRa, STNBY_MODE);
 		_LoRa->current_mode = STNBY_MODE;
-		//HAL_Delay(10);
-		//delay_ms(10);
 
-		read = LoRa_read(_LoRa, RegVersion);
-		if(read == 0x12)
-			return LORA_OK;
-		else
-			return LORA_NOT_FOUND;
+		// single readback of the whole configuration:
+		status = LoRa_verify(_LoRa);
+		_LoRa->timing.init_us = cycles_to_us(get_cycles() - start);
+		return status;
 	}
 	else {
 		return LORA_UNAVAILABLE;
 	}
 }
+
+/* ----------------------------------------------------------------------------- *\
+		name        : LoRa_recover
+
+		description : reset the module and bring it up again with the current LoRa
+									struct vars, e.g. after the radio stopped answering
+
+		arguments   :
+			LoRa* LoRa        --> LoRa object handler
+
+		returns     : same status codes as LoRa_init
+\* ----------------------------------------------------------------------------- */
+uint16_t LoRa_recover(LoRa* _LoRa){
+	uint16_t status;
+	uint32_t start = get_cycles();
+
+	LoRa_reset(_LoRa);
+	_LoRa->current_mode = STNBY_MODE;
+	status = LoRa_init(_LoRa);
+
+	_LoRa->timing.recovery_us = cycles_to_us(get_cycles() - start);
+	_LoRa->timing.recoveries++;
+	return status;
+}
@@ -0,0 +1,307 @@
+/**
+  ******************************************************************************
+  * @file    Log.c
+  * @brief   Ring-buffered UART output drained by DMA
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * log_write copies the message into a ring buffer and returns; the UART TX DMA
+  * sends the buffer one contiguous chunk at a time and the transfer-complete
+  * interrupt starts the next chunk. When the buffer is full the message is
+  * either dropped and counted or the caller sleeps until the DMA makes room,
+  * depending on the policy. Callers in interrupt context never block.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Log.h"
+#include <string.h>
+
+static UART_HandleTypeDef* logUart = NULL;
+static uint8_t            buffer[LOG_BUFFER_SIZE];
+static volatile uint32_t  head = 0;         // written by log_write
+static volatile uint32_t  tail = 0;         // advanced by the DMA completion
+static volatile uint16_t  dmaLen = 0;       // bytes of the chunk on the DMA, 0 if idle
+static uint8_t            logPolicy = LOG_POLICY_DROP;
+static uint8_t            logText = 1;      // text output enabled
+static Log_stats          stats;
+
+/**
+ * @brief   Start the DMA on the next contiguous chunk, if it is idle.
+ *
+ * @details Must be called with interrupts disabled.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void Log_kick() {
+	if (dmaLen != 0 || head == tail) {
+		return;
+	}
+
+	uint32_t start = tail % LOG_BUFFER_SIZE;
+	uint32_t len = head - tail;
+	if (len > LOG_BUFFER_SIZE - start) {
+		len = LOG_BUFFER_SIZE - start;
+	}
+	if (len > 0xFFFF) {
+		len = 0xFFFF;
+	}
+	dmaLen = len;
+	if (HAL_UART_Transmit_DMA(logUart, &buffer[start], len) != HAL_OK) {
+		dmaLen = 0;
+	}
+}
+
+/**
+ * @brief   Initialize the logger.
+ *
+ * @param   huart    UART used for the output, with its TX DMA linked.
+ * @param   policy   LOG_POLICY_DROP or LOG_POLICY_BLOCK.
+ *
+ * @return  None
+ */
+void Log_init(UART_HandleTypeDef* huart, uint8_t policy) {
+	logUart = huart;
+	logPolicy = policy;
+	head = tail = 0;
+	dmaLen = 0;
+	memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief   Select what happens when the buffer is full.
+ *
+ * @param   policy   LOG_POLICY_DROP or LOG_POLICY_BLOCK.
+ *
+ * @return  None
+ */
+void Log_setPolicy(uint8_t policy) {
+	logPolicy = policy;
+}
+
+/**
+ * @brief   Get the full-buffer policy.
+ *
+ * @param   None
+ *
+ * @return  LOG_POLICY_DROP or LOG_POLICY_BLOCK.
+ */
+uint8_t Log_getPolicy() {
+	return logPolicy;
+}
+
+/**
+ * @brief   Enable or mute the text output.
+ *
+ * @details While muted log_write and log_print discard their messages, so a binary
+ *          protocol can own the UART through Log_writeRaw.
+ *
+ * @param   enabled   1 to enable the text output, 0 to mute it.
+ *
+ * @return  None
+ */
+void Log_setText(uint8_t enabled) {
+	logText = enabled;
+}
+
+/**
+ * @brief   Queue text for output.
+ *
+ * @param   data   Bytes to send.
+ * @param   len    Number of bytes.
+ *
+ * @return  The number of bytes queued, 0 if the message was dropped or the text output
+ *          is muted.
+ */
+uint16_t log_write(const uint8_t* data, uint16_t len) {
+	if (!logText) {
+		return 0;
+	}
+	return Log_writeRaw(data, len);
+}
+
+/**
+ * @brief   Queue bytes for output, even while the text output is muted.
+ *
+ * @details Returns as soon as the bytes are in the ring buffer. With LOG_POLICY_BLOCK, or
+ *          for messages longer than the buffer, the caller sleeps until there is room,
+ *          unless it runs in interrupt context or with interrupts disabled, where the
+ *          message is dropped instead. The rest of a message still waiting after
+ *          LOG_BLOCK_TIMEOUT is dropped as well.
+ *
+ * @param   data   Bytes to send.
+ * @param   len    Number of bytes.
+ *
+ * @return  The number of bytes queued, 0 if the message was dropped.
+ */
+uint16_t Log_writeRaw(const uint8_t* data, uint16_t len) {
+	if (logUart == NULL || len == 0) {
+		return 0;
+	}
+
+	uint8_t canBlock = __get_IPSR() == 0 && __get_PRIMASK() == 0;
+	uint8_t waited = 0;
+	uint32_t waitStart = 0;
+	uint16_t queued = 0;
+
+	while (queued < len) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		uint32_t space = LOG_BUFFER_SIZE - (head - tail);
+		uint32_t chunk = len - queued;
+
+		if (chunk > space) {
+			// a stalled output (CTS held by the host) must not stop the caller for good
+			if (logPolicy == LOG_POLICY_DROP || !canBlock ||
+					(waited && HAL_GetTick() - waitStart >= LOG_BLOCK_TIMEOUT)) {
+				stats.dropped += len - queued;
+				__set_PRIMASK(primask);
+				return queued;
+			}
+			// a message that fits is never split, a longer one goes in pieces
+			if (len <= LOG_BUFFER_SIZE || space == 0) {
+				__set_PRIMASK(primask);
+				if (!waited) {
+					waited = 1;
+					waitStart = HAL_GetTick();
+				}
+				__WFI();
+				continue;
+			}
+			chunk = space;
+		}
+
+		uint32_t start = head % LOG_BUFFER_SIZE;
+		uint32_t first = chunk < LOG_BUFFER_SIZE - start ? chunk : LOG_BUFFER_SIZE - start;
+		memcpy(&buffer[start], data + queued, first);
+		memcpy(buffer, data + queued + first, chunk - first);
+		head += chunk;
+		queued += chunk;
+		stats.written += chunk;
+		if (head - tail > stats.maxDepth) {
+			stats.maxDepth = head - tail;
+		}
+		Log_kick();
+		__set_PRIMASK(primask);
+	}
+
+	if (waited) {
+		stats.blocked++;
+	}
+	return queued;
+}
+
+/**
+ * @brief   Queue a NUL-terminated string for output.
+ *
+ * @param   str   The string.
+ *
+ * @return  The number of bytes queued, 0 if the message was dropped.
+ */
+uint16_t log_print(const char* str) {
+	return log_write((const uint8_t*)str, strlen(str));
+}
+
+/**
+ * @brief   Release the chunk sent by the DMA and start the next one.
+ *
+ * @details Call it from HAL_UART_TxCpltCallback.
+ *
+ * @param   huart   UART that finished transmitting.
+ *
+ * @return  None
+ */
+void Log_onTxComplete(UART_HandleTypeDef* huart) {
+	if (huart != logUart) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	tail += dmaLen;
+	dmaLen = 0;
+	Log_kick();
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Recover the output after a UART error.
+ *
+ * @details Call it from HAL_UART_ErrorCallback. If the error aborted the TX DMA the chunk
+ *          is given up and the next one started, so writers never wait forever.
+ *
+ * @param   huart   UART that reported the error.
+ *
+ * @return  None
+ */
+void Log_onError(UART_HandleTypeDef* huart) {
+	if (huart != logUart || dmaLen == 0 || huart->gState != HAL_UART_STATE_READY) {
+		return;
+	}
+	Log_onTxComplete(huart);
+}
+
+/**
+ * @brief   Wait until every queued byte has been sent.
+ *
+ * @details Does not wait in interrupt context or with interrupts disabled. The wait is
+ *          bounded because with RTS/CTS a silent host can stop the output for good.
+ *
+ * @param   timeout_ms   Longest wait.
+ *
+ * @return  1 if the buffer is empty, 0 if bytes are still waiting.
+ */
+uint8_t Log_flush(uint32_t timeout_ms) {
+	if (__get_IPSR() != 0 || __get_PRIMASK() != 0) {
+		return head == tail;
+	}
+	uint32_t start = HAL_GetTick();
+	while (head != tail && HAL_GetTick() - start < timeout_ms) {
+		__WFI();
+	}
+	return head == tail;
+}
+
+/**
+ * @brief   Abort the output and throw away every queued byte.
+ *
+ * @details The bytes are counted as dropped. Used before reconfiguring the UART, when the
+ *          output could not drain.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Log_discard() {
+	if (logUart == NULL) {
+		return;
+	}
+	if (dmaLen != 0) {
+		HAL_UART_AbortTransmit(logUart);
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	stats.dropped += head - tail;
+	tail = head;
+	dmaLen = 0;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Get the logger statistics.
+ *
+ * @param   out   Where the statistics are stored.
+ *
+ * @return  None
+ */
+void Log_getStats(Log_stats* out) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*out = stats;
+	out->depth = head - tail;
+	__set_PRIMASK(primask);
+}
@@ -13,27 +13,58 @@
 #include "Main_App.h"
 //--------------LoRa-------------------------
 LoRa myLoRa;
+// received frames, filled by the DIO0 interrupt and drained by the main loop;
+// every frame buffer comes from the FramePool
+RxRing rxRing;
+uint8_t* rxFrame = NULL;	// ring block the FiFo is being copied into by the SPI DMA
 //--------------UART-------------------------
-#define UART_RX_BUFFER_SIZE 128
-char uartRxBuffer[UART_RX_BUFFER_SIZE];
-volatile uint8_t uartRxIndex = 0;
+#define UART_RX_BUFFER_SIZE 1024
+uint8_t uartRxBuffer[UART_RX_BUFFER_SIZE];	// circular DMA target
+volatile uint16_t uartRxIndex = 0;	// DMA position, published by the UART5 interrupts
+volatile uint16_t uartReadIndex = 0;	// read by the main loop
+volatile uint8_t uartRxResync = 0;	// data was overwritten, the main loop skips to uartRxIndex
+volatile uint32_t uartRxOverflows = 0;
+volatile uint32_t uartRxChunks = 0;
 // Variable global para almacenar el carácter recibido
 char SerialCmd;
+//--------------KISS-------------------------
+// binary mode: raw frames from and to the host PC, text output muted
+Kiss_decoder kissDecoder;
+uint8_t kissMode = 0;
+uint8_t* kissTxFrame = NULL;	// host frame waiting for the radio, a FramePool block
+uint8_t kissTxLen = 0;
+uint32_t kissTxDropped = 0;
+uint32_t kissRxDropped = 0;	// frames for the host dropped because the output was full
 
 // flags
-_Bool interruptEnabled = 1;
-_Bool transmissionReceived = 0;
+volatile _Bool transmissionDone = 0;
+// pending APP_EVT_xxx bits, set from interrupt context
+volatile uint32_t appEvents = 0;
+volatile uint32_t appEventCycles = 0;
+// scheduler tasks
+int8_t timerTask = SCHED_NO_TASK;
+int8_t rxTask = SCHED_NO_TASK;
+int8_t serialTask = SCHED_NO_TASK;
+int8_t txReportTask = SCHED_NO_TASK;
+int8_t sessionTask = SCHED_NO_TASK;
+int8_t uplinkTask = SCHED_NO_TASK;
+// software timers
+Timer expireTimer;
+// main loop instrumentation
+uint64_t idleCycles = 0;
+uint64_t loopCycles = 0;
+uint32_t dispatchLatency_us = 0;
+uint32_t dispatchLatencyMax_us = 0;
+_Bool gaplessReceive = 1;
 
-volatile uint32_t Time0 = 0;
-volatile uint32_t Time1 = 0;
-volatile uint32_t Time2 = 0;
-volatile uint32_t timeElapsed1 = 0;
-volatile uint32_t timeElapsed2 = 0;
 
 /**
  * @brief   Handle external interrupt DIO0.
  *
- * @details Set a flag to attend the received message
+ * @details Lets the driver finish an ongoing transmission, otherwise starts the SPI DMA
+ *          copy of the received frame into the next free slot of rxRing and returns;
+ *          onReceiveDone publishes it. The radio interrupt is always cleared, when the ring
+ *          is full the frame is dropped and counted.
  *
  * @param   None
  *
@@ -41,27 +72,97 @@ volatile uint32_t timeElapsed2 = 0;
  */
 void onInterrupt(){
 
-	if (!interruptEnabled) {
+	// TxDone edges are completed by the driver, stale ones ignored
+	if (Radio_onDIO0() != LORA_IRQ_RXDONE) {
 		return;
 	}
-	transmissionReceived = 1;
-	Time2 = HAL_GetTick();
-	timeElapsed2 = Time2 - Time1;
-	/*char timeElapsedStr[20];
-	snprintf(timeElapsedStr, sizeof(timeElapsedStr), "%lu", timeElapsed1);
-	HAL_UART_Transmit(&huart5, (uint8_t*)"Time1: ", strlen("Time1: "), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)timeElapsedStr, strlen(timeElapsedStr), 100);
-	snprintf(timeElapsedStr, sizeof(timeElapsedStr), "%lu", timeElapsed2);
-	HAL_UART_Transmit(&huart5, (uint8_t*)" Time2: ", strlen(" Time2: "), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)timeElapsedStr, strlen(timeElapsedStr), 100);*/
+	rxFrame = RxRing_reserve(&rxRing);
+	uint8_t length = rxFrame != NULL ? LORA_MAX_PAYLOAD : 0;
+	LoRa_receive_DMA(&myLoRa, rxFrame, length, gaplessReceive, onReceiveDone);
+}
+
+/**
+ * @brief   Publish the frame read after a DIO0 edge.
+ *
+ * @details Called by the driver from the SPI DMA completion interrupt, or from the DIO0
+ *          interrupt when there was nothing to copy.
+ *
+ * @param   _LoRa   The LoRa handler that read the frame.
+ *
+ * @return  None
+ */
+void onReceiveDone(LoRa* _LoRa){
+	if (rxFrame != NULL) {
+		rxFrame = NULL;
+		RxRing_commit(&rxRing, _LoRa->rxLength, LoRa_getRxMeta(_LoRa));
+	}
+	setAppEvent(APP_EVT_RADIO);
+}
+
+/**
+ * @brief   Handle the end of a SPI1 DMA transfer.
+ *
+ * @details Releases the radio bus so the next register access or FIFO burst can start.
+ *          Called from the HAL SPI complete/error callbacks.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void onSPITransferComplete(){
+	LoRa_DMA_complete(&myLoRa);
+}
+
+/**
+ * @brief   Handle the end of an asynchronous transmission.
+ *
+ * @details Called by the radio arbiter, from the DIO0 interrupt or from the timer wheel on
+ *          timeout, once the radio is back in continuous reception. Sets a flag so the result
+ *          is reported from the main loop.
+ *
+ * @param   _LoRa   The LoRa handler that finished transmitting.
+ *
+ * @return  None
+ */
+void onTransmitDone(LoRa* _LoRa){
+	if (_LoRa->txStatus) {
+		Corr_txDone();
+	}
+	Uplink_txDone(_LoRa->txStatus);
+	// the radio is free for the next queued command or session
+	wakeCommandTasks();
+	transmissionDone = 1;
+	setAppEvent(APP_EVT_TX_DONE);
+}
 
+/**
+ * @brief   Periodic timer expiring the requests that never got a response.
+ *
+ * @param   arg   Unused.
+ *
+ * @return  None
+ */
+void onExpireRequests(void* arg){
+	Corr_expire();
+}
+
+/**
+ * @brief   Notify hook of the timer wheel, called from SysTick_Handler.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void onTimersExpired(){
+	setAppEvent(APP_EVT_TIMER);
 }
 
 /**
  * @brief   Sends a LoRa frame with the specified function ID and optional data.
  *
- * @details This function constructs a LoRa frame with the provided function ID and optional data,
- *          transmits it using LoRa communication, and checks the transmission success.
+ * @details This function constructs a LoRa frame with the provided function ID and optional data
+ *          and starts its transmission. The frame is copied to the radio before returning; the
+ *          transmission success is reported from LoraApp_reportTransmission.
  *
  * @param   functionId  The function ID to be included in the LoRa frame.
  * @param   optDataLen  The length of the optional data to be included in the frame.
@@ -71,19 +172,27 @@ void onInterrupt(){
  */
 void sendFrame(uint8_t functionId, uint8_t optDataLen, uint8_t* optData) {
 	// build frame
-	uint8_t len = PCP_Get_Frame_Length(callsign, optDataLen);
-	uint8_t* frame = (uint8_t*)malloc(len * sizeof(uint8_t));
-	PCP_Encode(frame, callsign, functionId, optDataLen, optData);
+	int16_t len = PCP_Get_Frame_Length(callsign, optDataLen);
+	if (len > LORA_MAX_PAYLOAD) {
+		log_print("frame too long\r\n");
+		return;
+	}
+	uint8_t* txFrame = FramePool_alloc();
+	if (txFrame == NULL) {
+		log_print("no frame buffer\r\n");
+		return;
+	}
+	uint32_t start = get_cycles();
+	PCP_Encode(txFrame, callsign, functionId, optDataLen, optData);
 
-	// send data
-	uint8_t state = LoRa_transmit(&myLoRa, frame, len, 200);
-	free(frame);
+	// send data, the radio keeps its own copy
+	uint16_t state = Radio_transmit(txFrame, len);
+	FramePool_free(txFrame);
 
-	// check transmission success
-	if (state == 1) {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"sent successfully!\r\n", strlen("sent successfully!\r\n"), 100);
-	} else {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"failed\r\n", strlen("failed\r\n"), 100);
+	if (state == LORA_OK) {
+		Corr_sent(functionId, start);
+	} else if (state == LORA_BUSY) {
+		log_print("radio busy\r\n");
 	}
 }
 
@@ -91,25 +200,32 @@ void sendFrame(uint8_t functionId, uint8_t optDataLen, uint8_t* optData) {
  * @brief   Sends a LoRa frame with a default configuration and the specified function ID.
  *
  * @details This function constructs a LoRa frame with default configuration values and the provided
- *          function ID, transmits it using LoRa communication, and checks the transmission success.
+ *          function ID and starts its transmission. The transmission success is reported from
+ *          LoraApp_reportTransmission.
  *
  * @param   functionId  The function ID to be included in the LoRa frame.
  *
- * @return  transmissionSucces 1: success 0: failed
+ * @return  None
  */
 
 void sendFrame_Default(uint8_t functionId){
 	// build frame
+	uint8_t* txFrame = FramePool_alloc();
+	if (txFrame == NULL) {
+		log_print("no frame buffer\r\n");
+		return;
+	}
+	uint32_t start = get_cycles();
 	uint8_t len = PCP_Get_Frame_Length_Default(callsign);
-	uint8_t* frame = (uint8_t*)malloc(len * sizeof(uint8_t));
-	PCP_Encode_Default(frame, callsign, functionId);
-	// send data and check transmission success
-	if (LoRa_transmit(&myLoRa, frame, len, 100) == 1) {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"sent successfully!\r\n", strlen("sent successfully!\r\n"), 100);
-	} else {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"failed\r\n", strlen("failed\r\n"), 100);
+	PCP_Encode_Default(txFrame, callsign, functionId);
+	// send data, the radio keeps its own copy
+	uint16_t state = Radio_transmit(txFrame, len);
+	FramePool_free(txFrame);
+	if (state == LORA_OK) {
+		Corr_sent(functionId, start);
+	} else if (state == LORA_BUSY) {
+		log_print("radio busy\r\n");
 	}
-	free(frame);
 }
 
 /**
@@ -123,10 +239,207 @@ void sendFrame_Default(uint8_t functionId){
  * @return  None
  */
 void printControls(){
-	HAL_UART_Transmit(&huart5, (uint8_t*)"------------- Controls -------------\r\n", strlen("------------- Controls -------------\r\n"), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)"p - send ping frame\r\n", strlen("p - send ping frame\r\n"), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)"l - request last packet info\r\n", strlen("l - request last packet info\r\n"), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)"------------------------------------\r\n", strlen("------------------------------------\r\n"), 100);
+	log_print("------------- Controls -------------\r\n");
+	log_print("end every line with Enter\r\n");
+	log_print("p - queue ping frame\r\n");
+	log_print("l - request last packet info\r\n");
+	log_print("c - download camera picture\r\n");
+	log_print("t - print radio timing report\r\n");
+	log_print("r - reset and re-initialize the radio\r\n");
+	log_print("b - benchmark SPI register access\r\n");
+	log_print("m - print round-trip statistics\r\n");
+	log_print("g - toggle gapless/standby reception\r\n");
+	log_print("u - print uplink queue status\r\n");
+	log_print("o - toggle console drop/block when full\r\n");
+	log_print("k - KISS binary mode, FEND FF FEND returns\r\n");
+	log_print("h - toggle high-speed link with RTS/CTS\r\n");
+	log_print("w - measure console throughput\r\n");
+	log_print("help - list the satellite commands\r\n");
+	log_print("<command> [args] - send any satellite command\r\n");
+	log_print("------------------------------------\r\n");
+}
+
+/**
+ * @brief   Prints the per-operation timing report of the radio driver.
+ *
+ * @details Shows how long the last reset, init, mode switch, transmission and reception
+ *          took, in microseconds, as measured by the LoRa driver with the DWT cycle counter,
+ *          the frames lost, the time the radio spent deaf and the transmissions deferred by
+ *          the arbiter, the idle time and event latency of the main loop and the run count
+ *          and deadline misses of each task.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void printRadioTiming(){
+	LoRa_timing* timing = &myLoRa.timing;
+	Radio_stats radioStats;
+	FramePool_stats poolStats;
+	Log_stats logStats;
+	Link_stats linkStats;
+	char line[80];
+
+	Radio_getStats(&radioStats);
+	FramePool_getStats(&poolStats);
+	Log_getStats(&logStats);
+	log_print("----------- Radio timing -----------\r\n");
+	snprintf(line, sizeof(line), "reset          = %lu us\r\n", timing->reset_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "init           = %lu us\r\n", timing->init_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "recovery       = %lu us (%lu runs)\r\n", timing->recovery_us, timing->recoveries);
+	log_print(line);
+	snprintf(line, sizeof(line), "mode switch    = %lu us (max %lu)\r\n", timing->modeSwitch_us, timing->modeSwitchMax_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "mode timeouts  = %lu\r\n", timing->modeTimeouts);
+	log_print(line);
+	snprintf(line, sizeof(line), "tx load        = %lu us\r\n", timing->txLoad_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "tx on air      = %lu us\r\n", timing->txAir_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "tx turnaround  = %lu us\r\n", timing->txTurnaround_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "rx read        = %lu us\r\n", timing->rxRead_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "rx mode        = %s\r\n", gaplessReceive ? "gapless" : "standby");
+	log_print(line);
+	snprintf(line, sizeof(line), "rx frames      = %lu (lost %lu)\r\n", myLoRa.rxStats.frames, myLoRa.rxStats.lost);
+	log_print(line);
+	snprintf(line, sizeof(line), "deaf time      = %lu us\r\n", Radio_deaf_us());
+	log_print(line);
+	snprintf(line, sizeof(line), "  tx %lu, rx %lu, recovery %lu us\r\n", radioStats.txDeaf_us, radioStats.rxDeaf_us, radioStats.recoveryDeaf_us);
+	log_print(line);
+	snprintf(line, sizeof(line), "tx deferred    = %lu/%lu (max %lu ms, forced %lu)\r\n", radioStats.deferred, radioStats.transmissions, radioStats.maxDefer_ms, radioStats.forced);
+	log_print(line);
+	snprintf(line, sizeof(line), "rx queue       = %lu/%d (max %lu)\r\n", RxRing_depth(&rxRing), RX_RING_SIZE, rxRing.maxDepth);
+	log_print(line);
+	snprintf(line, sizeof(line), "rx overflows   = %lu\r\n", rxRing.overflows);
+	log_print(line);
+	snprintf(line, sizeof(line), "frame pool     = %lu/%lu (max %lu, failed %lu)\r\n", poolStats.inUse, poolStats.blocks, poolStats.highWater, poolStats.failures);
+	log_print(line);
+	snprintf(line, sizeof(line), "uart in        = %lu chunks, %lu overflows\r\n", uartRxChunks, uartRxOverflows);
+	log_print(line);
+	Link_getStats(&linkStats);
+	snprintf(line, sizeof(line), "uart link      = %lu baud, %s, %lu switches, %lu fallbacks\r\n", linkStats.baud, linkStats.flowControl ? "RTS/CTS" : "no flow control", linkStats.switches, linkStats.fallbacks);
+	log_print(line);
+	snprintf(line, sizeof(line), "kiss in        = %lu frames, %lu errors, %lu dropped\r\n", kissDecoder.frames, kissDecoder.errors, kissTxDropped);
+	log_print(line);
+	snprintf(line, sizeof(line), "kiss out       = %lu frames dropped\r\n", kissRxDropped);
+	log_print(line);
+	snprintf(line, sizeof(line), "uart out       = %lu/%d (max %lu), %s\r\n", logStats.depth, LOG_BUFFER_SIZE, logStats.maxDepth, Log_getPolicy() == LOG_POLICY_DROP ? "drop" : "block");
+	log_print(line);
+	snprintf(line, sizeof(line), "  dropped %lu bytes, %lu writes blocked\r\n", logStats.dropped, logStats.blocked);
+	log_print(line);
+	snprintf(line, sizeof(line), "cpu idle       = %lu.%lu %%\r\n", idlePermille() / 10, idlePermille() % 10);
+	log_print(line);
+	snprintf(line, sizeof(line), "wake->dispatch = %lu us (max %lu)\r\n", dispatchLatency_us, dispatchLatencyMax_us);
+	log_print(line);
+	for (uint8_t i = 0; i < Sched_count(); i++) {
+		Sched_task* task = Sched_get(i);
+		snprintf(line, sizeof(line), "task %-9s = %lu runs, %lu missed, max %lu us\r\n", task->name, task->runs, task->misses, task->maxRun_us);
+		log_print(line);
+	}
+	log_print("------------------------------------\r\n");
+}
+
+/**
+ * @brief   Prints the round-trip statistics of every command sent.
+ *
+ * @details For each command shows the responses and timeouts, the min/mean/max/p95 time from
+ *          the end of the uplink to the response DIO0 edge (satellite processing and both times
+ *          on air), and the mean time spent by the station itself sending and decoding.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void printRoundTrip(){
+	Corr_stats stats;
+	char line[80];
+
+	log_print("------------ Round trip ------------\r\n");
+	for (uint8_t i = 0; Corr_getStats(i, &stats); i++) {
+		snprintf(line, sizeof(line), "cmd 0x%02X: %lu resp, %lu timeouts\r\n", stats.functionId, stats.responses, stats.timeouts);
+		log_print(line);
+		if (stats.responses == 0) {
+			continue;
+		}
+		snprintf(line, sizeof(line), "  rtt min %lu / mean %lu / max %lu / p95 %lu ms\r\n",
+				stats.min_us / 1000, stats.mean_us / 1000, stats.max_us / 1000, stats.p95_us / 1000);
+		log_print(line);
+		snprintf(line, sizeof(line), "  station tx %lu us, rx %lu us\r\n", stats.uplink_us, stats.local_us);
+		log_print(line);
+	}
+	log_print("------------------------------------\r\n");
+}
+
+/**
+ * @brief   Compares the cost of a register access with both SPI backends.
+ *
+ * @details Runs the driver benchmark over 1000 accesses and prints the average CPU cycles of a
+ *          single register read and write through HAL_SPI and through the SPI data register.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void printSPIBenchmark(){
+	LoRa_spiBench bench;
+	char line[64];
+
+	LoRa_benchmark(&myLoRa, 1000, &bench);
+	log_print("---------- SPI benchmark -----------\r\n");
+	snprintf(line, sizeof(line), "read   HAL %lu / direct %lu cycles\r\n", bench.halRead_cycles, bench.regRead_cycles);
+	log_print(line);
+	snprintf(line, sizeof(line), "write  HAL %lu / direct %lu cycles\r\n", bench.halWrite_cycles, bench.regWrite_cycles);
+	log_print(line);
+	snprintf(line, sizeof(line), "driver backend: %s\r\n", LORA_SPI_BACKEND == LORA_SPI_BACKEND_REG ? "direct" : "HAL");
+	log_print(line);
+	log_print("------------------------------------\r\n");
+}
+
+/**
+ * @brief   Prints the link metadata of a received LoRa frame.
+ *
+ * @details Shows the packet RSSI, SNR and frequency error captured by the driver together
+ *          with the frame, and the HAL tick at which DIO0 signalled the reception.
+ *
+ * @param   meta   The metadata record of the received frame.
+ *
+ * @return  None
+ */
+void printRxMeta(LoRa_rxMeta* meta){
+	char line[64];
+	snprintf(line, sizeof(line), "RSSI %d dBm, SNR %.2f dB, FEI %ld Hz @ %lu ms\r\n",
+			meta->rssi, meta->snr / 4.0, meta->fei, meta->tick);
+	log_print(line);
+}
+
+/**
+ * @brief   Prints the state of the uplink command queue.
+ *
+ * @details Shows the commands still queued, the deepest the queue has been, how many
+ *          commands went out, failed or got no response and the rate achieved by the
+ *          current or last burst, in commands per minute.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void printUplink(){
+	Uplink_stats stats;
+	char line[64];
+
+	Uplink_getStats(&stats);
+	log_print("-------------- Uplink --------------\r\n");
+	snprintf(line, sizeof(line), "depth %lu (max %lu), dropped %lu\r\n", stats.depth, stats.maxDepth, stats.dropped);
+	log_print(line);
+	snprintf(line, sizeof(line), "sent %lu, failed %lu, no response %lu\r\n", stats.sent, stats.failed, stats.noResponse);
+	log_print(line);
+	snprintf(line, sizeof(line), "burst rate %lu cmd/min\r\n", stats.perMinute);
+	log_print(line);
+	log_print("------------------------------------\r\n");
 }
 
 /**
@@ -143,11 +456,11 @@ void printControls(){
  */
 void decode(uint8_t* respFrame, uint8_t respLen) {
 	// print raw data
-	HAL_UART_Transmit(&huart5, (uint8_t*)"Received ", strlen("Received "), 100);
+	log_print("Received ");
 	char respLenStr[4];
 	sprintf(respLenStr, "%d", respLen);
-	HAL_UART_Transmit(&huart5, (uint8_t*)respLenStr, strlen(respLenStr), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)" bytes:\r\n", strlen(" bytes:\r\n"), 100);
+	log_print(respLenStr);
+	log_print(" bytes:\r\n");
 
 	// get function ID
 	uint8_t functionId = PCP_Get_FunctionID(callsign, respFrame, respLen);
@@ -157,18 +470,23 @@ void decode(uint8_t* respFrame, uint8_t respLen) {
 	uint8_t* respOptData = NULL;
 	uint8_t respOptDataLen = 0;
 
-	// public frame
-	respOptDataLen = PCP_Get_OptData_Length(callsign, respFrame, respLen);
+	// public frame, a malformed one has no optional data
+	int16_t optDataLen = PCP_Get_OptData_Length(callsign, respFrame, respLen);
+	respOptDataLen = optDataLen > 0 ? optDataLen : 0;
 
-	HAL_UART_Transmit(&huart5, (uint8_t*)"Optional data (", strlen("Optional data ("), 100);
+	log_print("Optional data (");
 	char respOptDataLenStr[4];
 	sprintf(respOptDataLenStr, "%d", respOptDataLen);
-	HAL_UART_Transmit(&huart5, (uint8_t*)respOptDataLenStr, strlen(respOptDataLenStr), 100);
-	HAL_UART_Transmit(&huart5, (uint8_t*)" bytes):\r\n", strlen(" bytes):\r\n"), 100);
+	log_print(respOptDataLenStr);
+	log_print(" bytes):\r\n");
 
 	if (respOptDataLen > 0) {
 		// read optional data
-		uint8_t respOptData[respOptDataLen];
+		respOptData = FramePool_alloc();
+		if (respOptData == NULL) {
+			log_print("no frame buffer\r\n");
+			return;
+		}
 		// public frame
 		PCP_Get_OptData(callsign, respFrame, respLen, respOptData);
 	}
@@ -176,60 +494,63 @@ void decode(uint8_t* respFrame, uint8_t respLen) {
 	// process received frame
 	switch (functionId) {
 	case RESP_PONG:
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Pong!\r\n", strlen("Pong!\r\n"), 100);
+		log_print("Pong!\r\n");
 		break;
 
 	case RESP_PACKET_INFO: {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Packet info:\r\n", strlen("Packet info:\r\n"), 100);
+		// SNR, RSSI and four 16 bit frame counters
+		if (respOptDataLen < 10) {
+			log_print("Packet info too short\r\n");
+			break;
+		}
+		log_print("Packet info:\r\n");
 
-		HAL_UART_Transmit(&huart5, (uint8_t*)"SNR = ", strlen("SNR = "), 100);
+		log_print("SNR = ");
 		char respOptDataStr[10];
 		double calculatedValue = respOptData[0] / 4.0;
 		snprintf(respOptDataStr, sizeof(respOptDataStr), "%.2f", calculatedValue);
-		HAL_UART_Transmit(&huart5, (uint8_t*)respOptDataStr, strlen(respOptDataStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)" dB\r\n", strlen(" dB\r\n"), 100);
+		log_print(respOptDataStr);
+		log_print(" dB\r\n");
 
-		HAL_UART_Transmit(&huart5, (uint8_t*)"RSSI = ", strlen("RSSI = "), 100);
+		log_print("RSSI = ");
 		calculatedValue = respOptData[1]/ -2.0;
 		snprintf(respOptDataStr, sizeof(respOptDataStr), "%.2f", calculatedValue);
-		HAL_UART_Transmit(&huart5, (uint8_t*)respOptDataStr, strlen(respOptDataStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)" dBm\r\n", strlen(" dBm\r\n"), 100);
+		log_print(respOptDataStr);
+		log_print(" dBm\r\n");
 
 		uint16_t counter = 0;
-		HAL_UART_Transmit(&huart5, (uint8_t*)"valid LoRa frames = ", strlen("valid LoRa frames = "), 100);
+		log_print("valid LoRa frames = ");
 		memcpy(&counter, respOptData + 2, sizeof(uint16_t));
 		char counterStr[10];
 		sprintf(counterStr, "%d", counter);
-		HAL_UART_Transmit(&huart5, (uint8_t*)counterStr, strlen(counterStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)"\r\n", strlen("\r\n"), 100);
+		log_print(counterStr);
+		log_print("\r\n");
 
-		HAL_UART_Transmit(&huart5, (uint8_t*)"invalid LoRa frames = ", strlen("invalid LoRa frames = "), 100);
+		log_print("invalid LoRa frames = ");
 		memcpy(&counter, respOptData + 4, sizeof(uint16_t));
 		sprintf(counterStr, "%d", counter);
-		HAL_UART_Transmit(&huart5, (uint8_t*)counterStr, strlen(counterStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)"\r\n", strlen("\r\n"), 100);
+		log_print(counterStr);
+		log_print("\r\n");
 
-		HAL_UART_Transmit(&huart5, (uint8_t*)"valid FSK frames = ", strlen("valid FSK frames = "), 100);
+		log_print("valid FSK frames = ");
 		memcpy(&counter, respOptData + 6, sizeof(uint16_t));
 		sprintf(counterStr, "%d", counter);
-		HAL_UART_Transmit(&huart5, (uint8_t*)counterStr, strlen(counterStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)"\r\n", strlen("\r\n"), 100);
+		log_print(counterStr);
+		log_print("\r\n");
 
-		HAL_UART_Transmit(&huart5, (uint8_t*)"invalid FSK frames = ", strlen("invalid FSK frames = "), 100);
+		log_print("invalid FSK frames = ");
 		memcpy(&counter, respOptData + 8, sizeof(uint16_t));
 		sprintf(counterStr, "%d", counter);
-		HAL_UART_Transmit(&huart5, (uint8_t*)counterStr, strlen(counterStr), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)"\r\n", strlen("\r\n"), 100);
+		log_print(counterStr);
+		log_print("\r\n");
 	} break;
 
 	default:
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Unknown function ID!\r\n", strlen("Unknown function ID!\r\n"), 100);
+		log_print("Unknown function ID!\r\n");
 		break;
 	}
 
-	if (respOptDataLen > 0) {
-		free(respOptData);
-	}
+	FramePool_free(respOptData);
 }
 
 /**
@@ -243,28 +564,238 @@ void decode(uint8_t* respFrame, uint8_t respLen) {
  * @return  transmissionSucces 1: success 0: failed
  */
 void sendPing() {
-	HAL_UART_Transmit(&huart5, (uint8_t*)"Sending ping frame ... ", strlen("Sending ping frame ... "), 100);
+	// queue the frame, it is sent as soon as the uplink is free
+	if (Uplink_push(CMD_PING, 0, NULL, 1) != LORA_OK) {
+		log_print("uplink queue full\r\n");
+		return;
+	}
+	log_print("Sending ping frame ... ");
+	Sched_signal(uplinkTask);
+}
 
-	// send the frame
-	sendFrame_Default(CMD_PING);
+/**
+ * @brief   Queue a satellite command typed on the command line.
+ *
+ * @details Public commands wait for their response before the next queued command goes
+ *          out; private ones are answered with different function IDs, or not at all,
+ *          so they do not hold the uplink. The response is printed by decode().
+ *
+ * @param   verb         The command table entry.
+ * @param   optData      Optional data parsed from the arguments.
+ * @param   optDataLen   Number of optional data bytes.
+ *
+ * @return  None
+ */
+void sendCliCommand(const Cli_verb* verb, uint8_t* optData, uint8_t optDataLen) {
+	uint16_t state = Uplink_push(verb->functionId, optDataLen, optData, verb->expectResponse);
+	if (state == LORA_BUSY) {
+		log_print("uplink queue full\r\n");
+		return;
+	}
+	if (state == LORA_LARGE_PAYLOAD) {
+		log_print("optional data too long\r\n");
+		return;
+	}
+	log_print("Sending ");
+	log_print(verb->name);
+	log_print(" ... ");
+	Sched_signal(uplinkTask);
 }
 
 /**
  * @brief   Requests information about the last received packet over LoRa communication.
  *
- * @details This function sends a request for information about the last received packet
- *          over LoRa communication and notifies the user of the action by transmitting
- *          a message over UART communication.
+ * @details This function starts a packet info session, which sends the request as soon as
+ *          the radio is free and waits for the response, and notifies the user of the action
+ *          by transmitting a message over UART communication.
  *
  * @param   None
  *
- * @return  transmissionSucces 1: success 0: failed
+ * @return  None
  */
 void requestPacketInfo() {
-	HAL_UART_Transmit(&huart5, (uint8_t*)"Requesting last packet info ... ", strlen("Requesting last packet info ... "), 100);
+	log_print("Requesting last packet info ... ");
+
+	if (Session_start("packet info", packetInfoSession, 0) == NULL) {
+		log_print("no free session\r\n");
+	}
+}
+
+/**
+ * @brief   Session: send CMD_GET_PACKET_INFO and await RESP_PACKET_INFO.
+ *
+ * @details The response itself is printed by decode(), the session only reports a timeout.
+ *
+ * @param   s   The session.
+ *
+ * @return  CORO_WAITING while the exchange is in progress, CORO_ENDED when it is over.
+ */
+uint8_t packetInfoSession(Session* s) {
+	CORO_BEGIN(&s->coro);
+
+	SESSION_SEND(s, CMD_GET_PACKET_INFO, 0, NULL);
+	SESSION_AWAIT(s, RESP_PACKET_INFO, RESPONSE_TIMEOUT);
+	if (s->status == SESSION_TIMEOUT) {
+		log_print("packet info: no response\r\n");
+	}
+
+	CORO_END(&s->coro);
+}
+
+/**
+ * @brief   Downloads a camera picture over LoRa communication.
+ *
+ * @details This function starts a picture session for PICTURE_SLOT and notifies the user of
+ *          the action by transmitting a message over UART communication.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void requestPicture() {
+	log_print("Requesting picture ... ");
+
+	if (Session_start("picture", pictureSession, PICTURE_SLOT) == NULL) {
+		log_print("no free session\r\n");
+	}
+}
+
+/**
+ * @brief   Get the burst ID echoed at the start of a RESP_CAMERA_PICTURE.
+ *
+ * @param   s   The picture session, holding a response of at least 2 bytes.
+ *
+ * @return  The little-endian burst ID.
+ */
+uint16_t pictureBurstId(Session* s) {
+	return s->response[0] | (s->response[1] << 8);
+}
+
+/**
+ * @brief   Session: download the picture stored in camera slot s->arg.
+ *
+ * @details Requests the picture length (CMD_GET_PICTURE_LENGTH, 1 byte slot, answered with a
+ *          4 byte little-endian length), then every burst (CMD_GET_PICTURE_BURST, slot, 2 byte
+ *          burst ID and full-picture flag, answered with the burst ID followed by the picture
+ *          data) until the whole length is received. Answers echoing another burst ID, late
+ *          answers to a retried request, are ignored. A burst is requested again up to
+ *          RESPONSE_RETRIES times; an empty burst before the whole length is a failure.
+ *          Both commands are sent unencrypted.
+ *
+ * @param   s   The session.
+ *
+ * @return  CORO_WAITING while the exchange is in progress, CORO_ENDED when it is over.
+ */
+uint8_t pictureSession(Session* s) {
+	char line[48];
+
+	CORO_BEGIN(&s->coro);
+
+	s->request[0] = s->arg;
+	SESSION_SEND(s, CMD_GET_PICTURE_LENGTH, 1, s->request);
+	SESSION_AWAIT(s, RESP_CAMERA_PICTURE_LENGTH, RESPONSE_TIMEOUT);
+	if (s->status == SESSION_TIMEOUT || s->responseLen < sizeof(uint32_t)) {
+		log_print("picture: no length\r\n");
+		CORO_EXIT(&s->coro);
+	}
+	memcpy(&s->total, s->response, sizeof(uint32_t));
+	snprintf(line, sizeof(line), "picture: %lu bytes\r\n", s->total);
+	log_print(line);
+
+	s->done = 0;
+	s->index = 0;
+	s->retries = 0;
+	while (s->done < s->total) {
+		s->request[0] = s->arg;
+		memcpy(&s->request[1], &s->index, sizeof(uint16_t));
+		s->request[3] = 1;
+		SESSION_SEND(s, CMD_GET_PICTURE_BURST, 4, s->request);
+		SESSION_AWAIT(s, RESP_CAMERA_PICTURE, RESPONSE_TIMEOUT);
+		// a late answer to a retried request carries an earlier burst ID, keep waiting
+		while (s->status != SESSION_TIMEOUT &&
+				(s->responseLen < sizeof(uint16_t) || pictureBurstId(s) != s->index)) {
+			SESSION_AWAIT(s, RESP_CAMERA_PICTURE, RESPONSE_TIMEOUT);
+		}
+		if (s->status == SESSION_TIMEOUT) {
+			if (++s->retries > RESPONSE_RETRIES) {
+				log_print("picture: aborted\r\n");
+				CORO_EXIT(&s->coro);
+			}
+			continue;
+		}
+		// an empty burst means the satellite has nothing more to send
+		if (s->responseLen == sizeof(uint16_t)) {
+			break;
+		}
+		s->retries = 0;
+		s->done += s->responseLen - sizeof(uint16_t);
+		s->index++;
+		snprintf(line, sizeof(line), "picture: %lu/%lu bytes\r\n", s->done, s->total);
+		log_print(line);
+	}
+	if (s->done < s->total) {
+		snprintf(line, sizeof(line), "picture: failed, %lu/%lu bytes\r\n", s->done, s->total);
+		log_print(line);
+	} else {
+		log_print("picture: done\r\n");
+	}
+
+	CORO_END(&s->coro);
+}
+
+/**
+ * @brief   Check if the radio can take a new frame.
+ *
+ * @param   None
+ *
+ * @return  1 while a transmission is on air, otherwise 0.
+ */
+uint8_t radioBusy() {
+	return Radio_busy() || !Uplink_idle();
+}
+
+/**
+ * @brief   Resume the command sessions.
+ *
+ * @details Task released when a session starts, a frame is delivered to a session, a
+ *          response timeout expires or the radio becomes free.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_loopSessions() {
+	Session_runAll();
+}
 
-	// send the frame
-	sendFrame_Default(CMD_GET_PACKET_INFO);
+/**
+ * @brief   Drain the uplink queue.
+ *
+ * @details Task released when a command is queued, a transmission ends, a response
+ *          arrives or a response window closes, so queued commands go out back to back.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_loopUplink() {
+	Uplink_poll();
+	sendKissFrame();
+}
+
+/**
+ * @brief   Release the uplink and session tasks.
+ *
+ * @details Called whenever the radio may have become free for a new command: end of a
+ *          transmission, start of a session, closed response window.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void wakeCommandTasks() {
+	Sched_signal(uplinkTask);
+	Sched_signal(sessionTask);
 }
 
 /**
@@ -276,11 +807,12 @@ void requestPacketInfo() {
  *
  * @param   None
  *
- * @return  An int16_t status code indicating the initialization status of the LoRa module:
+ * @return  An uint16_t status code indicating the initialization status of the LoRa module:
  *          - LORA_OK: Initialization successful.
- *          - LORA_ERROR: Failed to initialize the LoRa module.
+ *          - LORA_NOT_FOUND: No SX127x answered on the SPI bus.
+ *          - LORA_MISMATCH: The configuration readback did not match.
  */
-uint8_t setLoRa(){
+uint16_t setLoRa(){
 	myLoRa = newLoRa();
 	myLoRa.CS_port         = NSS_GPIO_Port;
 	myLoRa.CS_pin          = NSS_Pin;
@@ -288,6 +820,7 @@ uint8_t setLoRa(){
 	myLoRa.reset_pin       = RST_Pin;
 	myLoRa.DIO0_port       = DIO0_GPIO_Port;
 	myLoRa.DIO0_pin        = DIO0_Pin;
+	myLoRa.DIO0_IRQn       = DIO0_EXTI_IRQn;
 	myLoRa.hSPIx           = &hspi1;
 
 	myLoRa.frequency             = LORA_FREQUENCY;             	// default = 433 MHz
@@ -304,6 +837,27 @@ uint8_t setLoRa(){
 	return LoRa_stat;
 }
 
+/**
+ * @brief   Resets and re-initializes the radio module.
+ *
+ * @details Runs the same reset and table-driven bring-up as the boot sequence with the
+ *          current settings, reports the result and the recovery time over UART and goes
+ *          back to continuous reception.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void recoverRadio(){
+	log_print("Recovering radio ... ");
+
+	uint16_t state = Radio_recover();
+
+	char recoveryStr[48];
+	snprintf(recoveryStr, sizeof(recoveryStr), "%s (%lu us)\r\n", state == LORA_OK ? "done" : "failed", myLoRa.timing.recovery_us);
+	log_print(recoveryStr);
+}
+
 /**
  * @brief   Initializes the LoRa application.
  *
@@ -316,42 +870,135 @@ uint8_t setLoRa(){
  * @return  None
  */
 void LoraApp_init(){
+	// console output is queued and sent by DMA from here on
+	Log_init(&huart5, LOG_POLICY_DROP);
+	Link_init(&huart5, restartSerialReception);
+	Cli_init(sendCliCommand, processSerialCommand);
+	FramePool_init();
+	RxRing_init(&rxRing);
+	Corr_init();
+	Timer_init(onTimersExpired);
+
+	// radio servicing runs before decoding, decoding before serial I/O
+	Sched_init();
+	timerTask    = Sched_add("timers", LoraApp_loopTimers, SCHED_PRIO_RADIO, 0, 5);
+	rxTask       = Sched_add("rx", LoraApp_loopReceive, SCHED_PRIO_RX, 0, 50);
+	serialTask   = Sched_add("serial", LoraApp_loopSerial, SCHED_PRIO_SERIAL, 0, 100);
+	txReportTask = Sched_add("txreport", LoraApp_reportTransmission, SCHED_PRIO_PRINT, 0, 100);
+	sessionTask  = Sched_add("session", LoraApp_loopSessions, SCHED_PRIO_SERIAL, 0, 20);
+	uplinkTask   = Sched_add("uplink", LoraApp_loopUplink, SCHED_PRIO_RADIO, 0, 20);
+	Session_init(sendFrame, radioBusy, wakeCommandTasks);
+	Uplink_init(callsign, RESPONSE_TIMEOUT, Radio_transmit, wakeCommandTasks);
+	Timer_start(&expireTimer, EXPIRE_PERIOD, EXPIRE_PERIOD, onExpireRequests, NULL);
+
 	// Iniciar la recepción UART en modo interrupción
-	HAL_UART_Receive_IT(&huart5, (uint8_t *)&uartRxBuffer[uartRxIndex], 1);
-	HAL_UART_Transmit(&huart5, (uint8_t*)"PLUTON-UPV Ground Station Demo Code\r\n", strlen("PLUTON-UPV Ground Station Demo Code\r\n"), 100);
+	startSerialReception();
+	log_print("PLUTON-UPV Ground Station Demo Code\r\n");
 
 	// initialize the radio
 	int state = setLoRa();
 
 
 	if (state == LORA_OK) {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Initialization successful!\r\n", strlen("Initialization successful!\r\n"), 100);
+		log_print("Initialization successful!\r\n");
+		char bootStr[48];
+		snprintf(bootStr, sizeof(bootStr), "Radio boot: reset %lu us, init %lu us\r\n", myLoRa.timing.reset_us, myLoRa.timing.init_us);
+		log_print(bootStr);
 	} else {
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Failed to initialize\r\n", strlen("Failed to initialize\r\n"), 100);
+		log_print("Failed to initialize\r\n");
 		while (1);
 	}
 
-	// begin listening for packets
-	LoRa_startReceiving(&myLoRa);
+	// begin listening for packets, the arbiter owns the radio from now on
+	Radio_init(&myLoRa, TRANSMISSION_TIMEOUT, onTransmitDone);
 	printControls();
 }
 /**
- * @brief   Process serial commands and manage UART communication.
+ * @brief   Start the circular DMA reception of UART5.
  *
- * @details This function processes serial commands received over UART and manages UART
- *          communication. It disables UART reception interrupts, processes the received
- *          command (e.g., 'p' for sending a ping frame or 'l' for requesting packet info),
- *          and then re-enables UART reception interrupts to listen for the next command.
+ * @details The DMA writes into uartRxBuffer forever; the half-transfer, transfer-complete
+ *          and IDLE-line interrupts report how far it got through onSerialChunk.
  *
  * @param   None
  *
  * @return  None
  */
-void LoraApp_loopSerial(){
-	// disable reception interrupt
-	interruptEnabled = 0;
-	// Carácter recibido en la UART5
-	SerialCmd = uartRxBuffer[uartRxIndex]; // Almacena el carácter en la variable global
+void startSerialReception(){
+	uartRxIndex = 0;
+	HAL_UARTEx_ReceiveToIdle_DMA(&huart5, uartRxBuffer, UART_RX_BUFFER_SIZE);
+}
+
+/**
+ * @brief   Restart the UART5 reception after a change of baud rate.
+ *
+ * @details The bytes not yet read were received at the old rate and are dropped.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void restartSerialReception(){
+	uartReadIndex = 0;
+	startSerialReception();
+}
+
+/**
+ * @brief   Publish the bytes received over UART5.
+ *
+ * @details Called from HAL_UARTEx_RxEventCallback on half transfer, transfer complete or
+ *          IDLE line. The bytes are already in uartRxBuffer, the function only moves the
+ *          write index to the DMA position. If the main loop fell a whole buffer behind the
+ *          unread bytes were overwritten: they are counted and skipped.
+ *
+ * @param   position   DMA position in uartRxBuffer, 1 to UART_RX_BUFFER_SIZE.
+ *
+ * @return  None
+ */
+void onSerialChunk(uint16_t position){
+	uint16_t index = position % UART_RX_BUFFER_SIZE;
+	uint16_t previous = uartRxIndex;
+	uint16_t received = (index - previous + UART_RX_BUFFER_SIZE) % UART_RX_BUFFER_SIZE;
+	uint16_t pending = (previous - uartReadIndex + UART_RX_BUFFER_SIZE) % UART_RX_BUFFER_SIZE;
+
+	if (pending + received >= UART_RX_BUFFER_SIZE) {
+		uartRxOverflows += pending + received - (UART_RX_BUFFER_SIZE - 1);
+		uartRxResync = 1;
+	}
+	uartRxIndex = index;
+	uartRxChunks++;
+	setAppEvent(APP_EVT_SERIAL);
+}
+
+/**
+ * @brief   Restart the UART5 reception after an error.
+ *
+ * @details Called from HAL_UART_ErrorCallback. Overrun, framing or noise errors abort the
+ *          DMA reception; the bytes not yet read are dropped and the reception restarted.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void onSerialError(){
+	if (huart5.RxState == HAL_UART_STATE_READY) {
+		uartRxOverflows++;
+		uartRxResync = 1;
+		startSerialReception();
+	}
+}
+
+/**
+ * @brief   Process one serial command.
+ *
+ * @details Runs the command received over UART (e.g., 'p' for sending a ping frame or 'l' for
+ *          requesting packet info). The radio arbiter keeps the radio in reception.
+ *
+ * @param   cmd   The command character.
+ *
+ * @return  None
+ */
+void processSerialCommand(char cmd){
+	SerialCmd = cmd;
 	// process serial command
 	switch (SerialCmd) {
 	case 'p':
@@ -360,76 +1007,504 @@ void LoraApp_loopSerial(){
 	case 'l':
 		requestPacketInfo();
 		break;
+	case 't':
+		printRadioTiming();
+		break;
+	case 'r':
+		recoverRadio();
+		break;
+	case 'c':
+		requestPicture();
+		break;
+	case 'b':
+		printSPIBenchmark();
+		break;
+	case 'm':
+		printRoundTrip();
+		break;
+	case 'u':
+		printUplink();
+		break;
+	case 'o':
+		if (Log_getPolicy() == LOG_POLICY_DROP) {
+			Log_setPolicy(LOG_POLICY_BLOCK);
+			log_print("console blocks when full\r\n");
+		} else {
+			Log_setPolicy(LOG_POLICY_DROP);
+			log_print("console drops when full\r\n");
+		}
+		break;
+	case 'h':
+		toggleFastLink();
+		break;
+	case 'w':
+		printUartThroughput();
+		break;
+	case 'k':
+		log_print("KISS mode, FEND FF FEND returns\r\n");
+		enterKissMode();
+		break;
+	case 'g':
+		gaplessReceive = !gaplessReceive;
+		if (gaplessReceive) {
+			log_print("gapless reception\r\n");
+		} else {
+			log_print("standby reception\r\n");
+		}
+		break;
 	default:
-		HAL_UART_Transmit(&huart5, (uint8_t*)"Unknown command: ", strlen("Unknown command: "), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)&SerialCmd, sizeof(SerialCmd), 100);
-		HAL_UART_Transmit(&huart5, (uint8_t*)"\r\n", strlen("\r\n"), 100);
+		log_print("Unknown command: ");
+		log_write((uint8_t*)&SerialCmd, sizeof(SerialCmd));
+		log_print("\r\n");
 		break;
 	}
-	LoRa_startReceiving(&myLoRa);
-	Time0 = HAL_GetTick();
-	// Incrementar el índice y evitar desbordamiento
-	uartRxIndex = (uartRxIndex + 1) % UART_RX_BUFFER_SIZE;
+}
+
+/**
+ * @brief   Feed a chunk of received bytes to the command parser.
+ *
+ * @details Text goes to the command line interface. While a baud rate switch waits for
+ *          the host the bytes go to the link negotiation, in KISS mode to the KISS decoder.
+ *          The mode is checked byte by byte, so a chunk holding both the 'k' command and
+ *          the first frame is split correctly.
+ *
+ * @param   data   Received bytes.
+ * @param   len    Number of bytes.
+ *
+ * @return  None
+ */
+void processSerialChunk(uint8_t* data, uint16_t len){
+	Link_stats linkStats;
+	char line[40];
+
+	for (uint16_t i = 0; i < len; i++) {
+		if (Link_confirming()) {
+			if (Link_onByte(data[i]) && !Link_confirming()) {
+				Link_getStats(&linkStats);
+				snprintf(line, sizeof(line), "link at %lu baud, RTS/CTS\r\n", linkStats.baud);
+				log_print(line);
+			}
+		} else if (kissMode) {
+			Kiss_decode(&kissDecoder, &data[i], 1);
+		} else {
+			Cli_input((char)data[i]);
+		}
+	}
+}
+
+/**
+ * @brief   Switch the console between the default and the high-speed link.
+ *
+ * @details The new rate is announced at the current one. Going up, the host has
+ *          LINK_CONFIRM_MS to reopen its port at LINK_FAST_BAUD with RTS/CTS and send
+ *          LINK_CONFIRM_BYTE, otherwise the link falls back to LINK_DEFAULT_BAUD. Going
+ *          down needs no confirmation, the default rate is always reachable.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void toggleFastLink(){
+	Link_stats linkStats;
+	char line[64];
+
+	Link_getStats(&linkStats);
+	if (linkStats.state == LINK_FAST) {
+		snprintf(line, sizeof(line), "switching to %d baud\r\n", LINK_DEFAULT_BAUD);
+		log_print(line);
+		Link_fallback();
+		return;
+	}
+	snprintf(line, sizeof(line), "switching to %d baud RTS/CTS, send '%c'\r\n", LINK_FAST_BAUD, LINK_CONFIRM_BYTE);
+	log_print(line);
+	if (Link_negotiate(LINK_FAST_BAUD) != LORA_OK) {
+		log_print("baud rate not supported\r\n");
+	}
+}
+
+/**
+ * @brief   Measure the sustained throughput of the console.
+ *
+ * @details Sends UART_BENCH_BYTES of text through the logger, sleeping while the buffer
+ *          is full, and times them until the last byte has left. The result is compared
+ *          with the line rate, 10 bits per byte, so runs at different baud rates or with
+ *          and without flow control can be compared.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void printUartThroughput(){
+	Link_stats linkStats;
+	char line[80];
+	uint8_t policy = Log_getPolicy();
+
+	memset(line, 'U', sizeof(line) - 2);
+	line[sizeof(line) - 2] = '\r';
+	line[sizeof(line) - 1] = '\n';
+
+	Log_flush(UART_BENCH_TIMEOUT);
+	Log_setPolicy(LOG_POLICY_BLOCK);
+	uint32_t start = get_cycles();
+	for (uint32_t sent = 0; sent < UART_BENCH_BYTES; sent += sizeof(line)) {
+		log_write((uint8_t*)line, sizeof(line));
+	}
+	uint8_t drained = Log_flush(UART_BENCH_TIMEOUT);
+	uint32_t elapsed_us = cycles_to_us(get_cycles() - start);
+	Log_setPolicy(policy);
+	if (!drained) {
+		log_print("\r\nuart throughput: output stalled\r\n");
+		return;
+	}
+
+	Link_getStats(&linkStats);
+	uint32_t bytesPerSecond = (uint32_t)((uint64_t)UART_BENCH_BYTES * 1000000 / (elapsed_us ? elapsed_us : 1));
+	snprintf(line, sizeof(line), "\r\nuart throughput = %lu B/s at %lu baud, %lu%% of line rate\r\n",
+			bytesPerSecond, linkStats.baud, (uint32_t)((uint64_t)bytesPerSecond * 1000 / linkStats.baud));
+	log_print(line);
+}
+
+/**
+ * @brief   Switch the serial console to KISS binary mode.
+ *
+ * @details The host sends raw PCP frames as KISS data frames on port 0 and gets back every
+ *          received frame on port 0 followed by its metadata on port 1. Text output is muted
+ *          until the host sends the KISS return command (FEND FF FEND).
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void enterKissMode(){
+	Kiss_init(&kissDecoder, onKissFrame);
+	kissMode = 1;
+	Log_setText(0);
+}
+
+/**
+ * @brief   Handle a frame decoded from the host in KISS mode.
+ *
+ * @details Port 0 data frames are transmitted as they are. Only one host frame waits for
+ *          the radio, frames arriving while it waits are dropped and counted; the host is
+ *          expected to pace its frames on the echo of the responses.
+ *
+ * @param   command   KISS command byte.
+ * @param   data      Frame data.
+ * @param   len       Number of data bytes.
+ *
+ * @return  None
+ */
+void onKissFrame(uint8_t command, uint8_t* data, uint16_t len){
+	if (command == KISS_CMD_RETURN) {
+		kissMode = 0;
+		Log_setText(1);
+		log_print("text mode\r\n");
+		return;
+	}
+	if (command != ((KISS_PORT_FRAME << 4) | KISS_CMD_DATA)) {
+		return;
+	}
+	if (len == 0 || len > LORA_MAX_PAYLOAD || kissTxFrame != NULL) {
+		kissTxDropped++;
+		return;
+	}
+	kissTxFrame = FramePool_alloc();
+	if (kissTxFrame == NULL) {
+		kissTxDropped++;
+		return;
+	}
+	memcpy(kissTxFrame, data, len);
+	kissTxLen = len;
+	sendKissFrame();
+}
+
+/**
+ * @brief   Transmit the host frame waiting for the radio.
+ *
+ * @details Called when the frame arrives and again from the uplink task whenever the radio
+ *          may have become free. Frames carrying this station's callsign are timed by the
+ *          correlator like the ones built locally.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void sendKissFrame(){
+	if (kissTxFrame == NULL) {
+		return;
+	}
+	uint32_t start = get_cycles();
+	uint16_t state = Radio_transmit(kissTxFrame, kissTxLen);
+	if (state == LORA_BUSY) {
+		return;
+	}
+	if (state == LORA_OK) {
+		int16_t functionId = PCP_Get_FunctionID(callsign, kissTxFrame, kissTxLen);
+		if (functionId >= 0) {
+			Corr_sent(functionId, start);
+		}
+	} else {
+		kissTxDropped++;
+	}
+	FramePool_free(kissTxFrame);
+	kissTxFrame = NULL;
+}
 
-	// Reiniciar la recepción para esperar el próximo carácter
-	HAL_UART_Receive_IT(&huart5, (uint8_t *)&uartRxBuffer[uartRxIndex], 1);
+/**
+ * @brief   Send a received frame and its metadata to the host in KISS mode.
+ *
+ * @details The payload goes out on port 0, skipped for frames with a CRC error, then the
+ *          metadata on port 1, little endian: length (1), RSSI in dBm (2), SNR in 0.25 dB
+ *          steps (1), frequency error in Hz (4), HAL tick at DIO0 (4) and flags (1, bit 0
+ *          CRC error, bit 1 valid header, bit 2 CRC on).
+ *
+ * @param   frame   The received frame.
+ * @param   data    Its payload.
+ *
+ * @return  None
+ */
+void reportKissFrame(RxRing_frame* frame, uint8_t* data){
+	LoRa_rxMeta* meta = &frame->meta;
+	uint8_t out[13];
 
-	interruptEnabled = 1;
+	if (!meta->crcError &&
+			Kiss_encode((KISS_PORT_FRAME << 4) | KISS_CMD_DATA, data, frame->length, Log_writeRaw) == 0) {
+		kissRxDropped++;
+	}
+	out[0] = frame->length;
+	out[1] = (uint8_t)meta->rssi;
+	out[2] = (uint8_t)(meta->rssi >> 8);
+	out[3] = (uint8_t)meta->snr;
+	for (uint8_t i = 0; i < 4; i++) {
+		out[4 + i] = (uint8_t)((uint32_t)meta->fei >> (8 * i));
+		out[8 + i] = (uint8_t)(meta->tick >> (8 * i));
+	}
+	out[12] = (meta->crcError ? 0x01 : 0) | (meta->headerValid ? 0x02 : 0) | (meta->crcOn ? 0x04 : 0);
+	if (Kiss_encode((KISS_PORT_META << 4) | KISS_CMD_DATA, out, sizeof(out), Log_writeRaw) == 0) {
+		kissRxDropped++;
+	}
+}
 
+/**
+ * @brief   Process serial input published by the UART interrupts.
+ *
+ * @details Called from the main loop. Hands the bytes received since the last run to the
+ *          parser as contiguous chunks of uartRxBuffer, so frame building and transmission
+ *          never happen in interrupt context and radio receptions are not delayed while a
+ *          command is typed.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_loopSerial(){
+	if (uartRxResync) {
+		uartRxResync = 0;
+		uartReadIndex = uartRxIndex;
+	}
+	while (uartReadIndex != uartRxIndex) {
+		uint16_t end = uartRxIndex;
+		if (end < uartReadIndex) {
+			end = UART_RX_BUFFER_SIZE;
+		}
+		uint16_t start = uartReadIndex;
+		uartReadIndex = end % UART_RX_BUFFER_SIZE;
+		processSerialChunk(&uartRxBuffer[start], end - start);
+	}
+}
+
+/**
+ * @brief   Run the callbacks of the expired software timers.
+ *
+ * @details Task released by the timer wheel from SysTick_Handler: transmission and
+ *          response timeouts and the periodic request expiry run here.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_loopTimers(){
+	Timer_dispatch();
+}
+
+/**
+ * @brief   Report the result of the last asynchronous transmission.
+ *
+ * @details Task released by the transmission-complete callback.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_reportTransmission(){
+	if (transmissionDone) {
+		transmissionDone = 0;
+		if (myLoRa.txStatus) {
+			log_print("sent successfully!\r\n");
+		} else {
+			log_print("failed\r\n");
+		}
+	}
 }
 
 /**
  * @brief   Process received LoRa data and decode the received frame.
  *
- * @details This function reads received data from the LoRa module, checks if new data
- *          has been received, and if so, it processes the received frame by decoding it.
- *          It temporarily disables the reception interrupt, decodes the received frame,
- *          and then re-enables the reception interrupt for further data reception.
+ * @details Task released by the DIO0 interrupt. Decodes the oldest frame queued in rxRing
+ *          and releases itself again while frames remain, so higher priority tasks can run
+ *          between two frames of a burst.
  *
  * @param   None
  *
  * @return  None
  */
 void LoraApp_loopReceive(){
-		// check if new data were received
-		if (transmissionReceived) {
-			// disable reception interrupt
-			interruptEnabled = 0;
-			transmissionReceived = 0;
-
-			// read received data
-			uint8_t* respFrame = (uint8_t*)malloc(20 * sizeof(uint8_t));
-			size_t respLen = LoRa_receive(&myLoRa, respFrame, 11);
-			Time1 = HAL_GetTick();
-			timeElapsed1 = Time1 - Time0;
-
-
-			// check reception success
-			decode(respFrame, respLen);
-
-			/*if (state == ERR_NONE) {
-			      decode(respFrame, respLen);
-
-			    } else if (state == ERR_CRC_MISMATCH) {//ERR_CRC_MISMATCH
-			      Serial.println(F("Got CRC error!"));
-			      Serial.print(F("Received "));
-			      Serial.print(respLen);
-			      Serial.println(F(" bytes:"));
-			      //PRINT_BUFF(respFrame, respLen);
-
-			    } else {
-			      Serial.println(F("Reception failed, code "));
-			      Serial.println(state);
-
-			    }*/
-			free(respFrame);
-			// enable reception interrupt
-			LoRa_startReceiving(&myLoRa);
-			interruptEnabled = 1;
+	RxRing_frame* frame = RxRing_peek(&rxRing);
+	if (frame == NULL) {
+		return;
+	}
+	uint8_t* respFrame = RxRing_data(&rxRing, frame);
+	if (kissMode) {
+		reportKissFrame(frame, respFrame);
+	}
+	// check reception success
+	if (frame->meta.crcError) {
+		log_print("CRC error, frame dropped\r\n");
+	} else {
+		if (!kissMode) {
+			printRxMeta(&frame->meta);
+			decode(respFrame, frame->length);
 		}
 
+		// hand the response to the session waiting for it
+		int16_t functionId = PCP_Get_FunctionID(callsign, respFrame, frame->length);
+		int16_t optDataLen = PCP_Get_OptData_Length(callsign, respFrame, frame->length);
+		uint8_t* sessionOptData = FramePool_alloc();
+		if (functionId >= 0 && optDataLen >= 0 && sessionOptData != NULL) {
+			if (optDataLen > 0) {
+				PCP_Get_OptData(callsign, respFrame, frame->length, sessionOptData);
+			}
+			if (Session_deliver(functionId, sessionOptData, optDataLen)) {
+				Sched_signal(sessionTask);
+			}
+		}
+		FramePool_free(sessionOptData);
+		if (functionId >= 0) {
+			Corr_response(functionId, frame->meta.cycles);
+			Uplink_response(functionId);
+			wakeCommandTasks();
+		}
+	}
+	RxRing_release(&rxRing);
 
+	if (RxRing_depth(&rxRing) > 0) {
+		Sched_signal(rxTask);
+	}
 }
 
+/**
+ * @brief   Signal an event to the main loop.
+ *
+ * @details Safe to call from any interrupt priority. Releases the task that handles the
+ *          event and wakes the main loop. The cycle count of the first event since the last
+ *          dispatch is kept to measure the wake-to-dispatch latency.
+ *
+ * @param   event   APP_EVT_xxx bits to set.
+ *
+ * @return  None
+ */
+void setAppEvent(uint32_t event){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (appEvents == 0) {
+		appEventCycles = get_cycles();
+	}
+	appEvents |= event;
+	__set_PRIMASK(primask);
 
+	if (event & APP_EVT_RADIO) {
+		Sched_signal(rxTask);
+	}
+	if (event & APP_EVT_SERIAL) {
+		Sched_signal(serialTask);
+	}
+	if (event & APP_EVT_TX_DONE) {
+		Sched_signal(txReportTask);
+	}
+	if (event & APP_EVT_TIMER) {
+		Sched_signal(timerTask);
+	}
+}
 
+/**
+ * @brief   Get the share of time the core spent sleeping.
+ *
+ * @param   None
+ *
+ * @return  Idle time since boot, in tenths of percent.
+ */
+uint32_t idlePermille(){
+	if (loopCycles == 0) {
+		return 0;
+	}
+	return (uint32_t)((idleCycles * 1000) / loopCycles);
+}
+
+/**
+ * @brief   Sleep until an event is pending.
+ *
+ * @details Interrupts are masked while the event bits are checked, so an event raised just
+ *          before __WFI still wakes the core. The pending interrupt runs once they are
+ *          unmasked again. Time spent in __WFI is accounted as idle time. The 1 ms SysTick
+ *          also wakes the core, which keeps the transmission timeout running.
+ *
+ * @param   None
+ *
+ * @return  The APP_EVT_xxx bits that were pending, cleared.
+ */
+uint32_t LoraApp_waitEvents(){
+	static uint32_t last = 0;
+	uint32_t events;
+	uint32_t now;
+
+	__disable_irq();
+	if (appEvents == 0) {
+		now = get_cycles();
+		__WFI();
+		idleCycles += get_cycles() - now;
+	}
+	__enable_irq();
+
+	__disable_irq();
+	events = appEvents;
+	appEvents = 0;
+	now = get_cycles();
+	__enable_irq();
+
+	loopCycles += now - last;
+	last = now;
+	if (events != 0) {
+		dispatchLatency_us = cycles_to_us(now - appEventCycles);
+		if (dispatchLatency_us > dispatchLatencyMax_us) {
+			dispatchLatencyMax_us = dispatchLatency_us;
+		}
+	}
+	return events;
+}
+
+/**
+ * @brief   Run one iteration of the event-driven main loop.
+ *
+ * @details Sleeps until an interrupt signals an event or the SysTick wakes the core, then
+ *          runs every ready task in priority order. Tasks are released directly by the
+ *          interrupts, so work arriving while a task runs is picked up before sleeping again.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void LoraApp_loop(){
+	LoraApp_waitEvents();
+	while (Sched_runNext()) {
+	}
+}
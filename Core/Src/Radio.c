@@ -0,0 +1,282 @@
+/**
+  ******************************************************************************
+  * @file    Radio.c
+  * @brief   Half-duplex arbiter owning the SX127x between reception and
+  * 		 transmission
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * The radio rests in RX continuous. A transmission request is copied and only
+  * started when RegModemStat shows no reception in progress; otherwise it waits
+  * for the RxDone of that packet, polling the modem every RADIO_DEFER_POLL_MS
+  * and giving up after RADIO_DEFER_MAX_MS. Completed receptions are always read
+  * from the DIO0 interrupt, whatever the arbiter state, so none is discarded.
+  * Every interval the radio can not hear is accounted as deaf time.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Radio.h"
+#include "FramePool.h"
+#include <string.h>
+
+static LoRa*            radio = NULL;
+static uint16_t         radioTxTimeout = 0;
+static LoRa_callback    radioTxDone = NULL;
+static volatile uint8_t state = RADIO_RX;
+
+// request waiting for the channel
+static uint8_t*         pending = NULL;      // FramePool block
+static uint8_t          pendingLen = 0;
+static uint32_t         pendingTick = 0;
+static uint8_t          pendingDeferred = 0;
+
+static Timer            deferTimer;
+static Timer            txTimer;
+static uint32_t         deafStart = 0;
+static Radio_stats      stats;
+
+static void Radio_service();
+
+/**
+ * @brief   End of a transmission, called by the LoRa driver.
+ *
+ * @details Runs from the DIO0 interrupt on TxDone, or from the timer wheel on timeout once
+ *          Radio_txTimeout aborted the transmission. The driver is already back in RX continuous.
+ *
+ * @param   _LoRa   The LoRa handler.
+ *
+ * @return  None
+ */
+static void Radio_txDone(LoRa* _LoRa) {
+	Timer_stop(&txTimer);
+	// the FiFo load is over, the block is no longer needed
+	FramePool_free(pending);
+	pending = NULL;
+	stats.txDeaf_us += cycles_to_us(get_cycles() - deafStart);
+	state = RADIO_RX;
+	if (radioTxDone != NULL) {
+		radioTxDone(_LoRa);
+	}
+}
+
+/**
+ * @brief   Transmission timeout, run from the timer wheel.
+ *
+ * @details The driver has no timeout of its own, the expiry of this timer ends the
+ *          transmission.
+ *
+ * @param   arg   Unused.
+ *
+ * @return  None
+ */
+static void Radio_txTimeout(void* arg) {
+	LoRa_abortTransmit(radio);
+}
+
+/**
+ * @brief   Deferral poll, run from the timer wheel.
+ *
+ * @param   arg   Unused.
+ *
+ * @return  None
+ */
+static void Radio_deferExpired(void* arg) {
+	Radio_service();
+}
+
+/**
+ * @brief   Report a request that never reached the air as a failed transmission.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void Radio_dropPending() {
+	FramePool_free(pending);
+	pending = NULL;
+	state = RADIO_RX;
+	radio->txStatus = 0;
+	if (radioTxDone != NULL) {
+		radioTxDone(radio);
+	}
+}
+
+/**
+ * @brief   Start the pending transmission if no packet is being received.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void Radio_service() {
+	if (state != RADIO_TX_PENDING) {
+		return;
+	}
+
+	uint32_t waited = HAL_GetTick() - pendingTick;
+	if (LoRa_isReceiving(radio)) {
+		if (waited < RADIO_DEFER_MAX_MS) {
+			pendingDeferred = 1;
+			Timer_start(&deferTimer, RADIO_DEFER_POLL_MS, 0, Radio_deferExpired, NULL);
+			return;
+		}
+		stats.forced++;
+	}
+	if (pendingDeferred) {
+		stats.deferred++;
+		if (waited > stats.maxDefer_ms) {
+			stats.maxDefer_ms = waited;
+		}
+	}
+
+	Timer_stop(&deferTimer);
+	Timer_start(&txTimer, radioTxTimeout, 0, Radio_txTimeout, NULL);
+	deafStart = get_cycles();
+	state = RADIO_TX;
+	// the block is read by the SPI DMA, it is freed when the transmission ends
+	uint16_t status = LoRa_transmit_IT(radio, pending, pendingLen, Radio_txDone);
+	if (status != LORA_OK) {
+		Timer_stop(&txTimer);
+		Radio_dropPending();
+		return;
+	}
+	stats.transmissions++;
+}
+
+/**
+ * @brief   Initialize the arbiter and start listening.
+ *
+ * @param   lora           The LoRa handler, already initialized.
+ * @param   txTimeout_ms   Transmission timeout.
+ * @param   onTxDone       Called when a transmission accepted by Radio_transmit ends;
+ *                         txStatus is 1 on success, 0 on timeout or failure.
+ *
+ * @return  None
+ */
+void Radio_init(LoRa* lora, uint16_t txTimeout_ms, LoRa_callback onTxDone) {
+	radio = lora;
+	radioTxTimeout = txTimeout_ms;
+	radioTxDone = onTxDone;
+	Timer_stop(&deferTimer);
+	Timer_stop(&txTimer);
+	memset(&stats, 0, sizeof(stats));
+	state = RADIO_RX;
+	LoRa_startReceiving(radio);
+}
+
+/**
+ * @brief   Request the transmission of a frame.
+ *
+ * @details The frame is copied, so the caller may reuse its buffer. It goes on air at once
+ *          if the channel is quiet, otherwise after the reception in progress.
+ *
+ * @param   frame   The encoded frame.
+ * @param   len     Length of the frame.
+ *
+ * @return  LORA_OK if the request was accepted, LORA_BUSY if another one is pending or
+ *          on air or no frame buffer is free, LORA_UNAVAILABLE if the radio is being
+ *          recovered.
+ */
+uint16_t Radio_transmit(uint8_t* frame, uint8_t len) {
+	if (radio == NULL || state == RADIO_RECOVERING) {
+		return LORA_UNAVAILABLE;
+	}
+	if (state != RADIO_RX) {
+		return LORA_BUSY;
+	}
+
+	pending = FramePool_alloc();
+	if (pending == NULL) {
+		return LORA_BUSY;
+	}
+	memcpy(pending, frame, len);
+	pendingLen = len;
+	pendingTick = HAL_GetTick();
+	pendingDeferred = 0;
+	state = RADIO_TX_PENDING;
+	Radio_service();
+	return LORA_OK;
+}
+
+/**
+ * @brief   Handle a DIO0 edge.
+ *
+ * @details Call it from the DIO0 interrupt. On LORA_IRQ_RXDONE the caller must start
+ *          reading the packet before returning; a pending transmission is then started from the timer
+ *          wheel, right after the interrupt.
+ *
+ * @param   None
+ *
+ * @return  LORA_IRQ_RXDONE, LORA_IRQ_TXDONE or LORA_IRQ_NONE.
+ */
+uint8_t Radio_onDIO0() {
+	uint8_t irq = LoRa_onDIO0(radio);
+	if (irq == LORA_IRQ_RXDONE && state == RADIO_TX_PENDING) {
+		Timer_start(&deferTimer, 1, 0, Radio_deferExpired, NULL);
+	}
+	return irq;
+}
+
+/**
+ * @brief   Check if the radio can take a new transmission request.
+ *
+ * @param   None
+ *
+ * @return  Non zero while a request is pending, on air or the radio is being recovered.
+ */
+uint8_t Radio_busy() {
+	return state != RADIO_RX;
+}
+
+/**
+ * @brief   Reset and re-initialize the radio, then listen again.
+ *
+ * @details A pending request is dropped and a transmission on air is aborted; both are
+ *          reported as failed to the transmission callback.
+ *
+ * @param   None
+ *
+ * @return  Same status codes as LoRa_init.
+ */
+uint16_t Radio_recover() {
+	Timer_stop(&deferTimer);
+	if (state == RADIO_TX_PENDING) {
+		Radio_dropPending();
+	} else if (state == RADIO_TX) {
+		LoRa_abortTransmit(radio);
+	}
+
+	state = RADIO_RECOVERING;
+	uint32_t start = get_cycles();
+	uint16_t status = LoRa_recover(radio);
+	LoRa_startReceiving(radio);
+	stats.recoveryDeaf_us += cycles_to_us(get_cycles() - start);
+	state = RADIO_RX;
+	return status;
+}
+
+/**
+ * @brief   Get the total time the radio could not hear since boot.
+ *
+ * @param   None
+ *
+ * @return  Deaf time in microseconds.
+ */
+uint32_t Radio_deaf_us() {
+	return stats.txDeaf_us + radio->rxStats.deaf_us + stats.recoveryDeaf_us;
+}
+
+/**
+ * @brief   Get the arbiter statistics.
+ *
+ * @param   out   Where the statistics are stored.
+ *
+ * @return  None
+ */
+void Radio_getStats(Radio_stats* out) {
+	memcpy(out, &stats, sizeof(Radio_stats));
+	out->state = state;
+	out->rxDeaf_us = radio->rxStats.deaf_us;
+}
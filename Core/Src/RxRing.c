@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    RxRing.c
+  * @brief   Lock-free handoff of received LoRa frames from the DIO0 interrupt
+  * 		 to the main loop
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "RxRing.h"
+#include <string.h>
+
+/**
+ * @brief   Initialize an empty ring.
+ *
+ * @details Clears the indexes and the depth and overflow counters. Must be called before
+ *          the DIO0 interrupt can produce frames.
+ *
+ * @param   ring    A pointer to the ring.
+ *
+ * @return  None
+ */
+void RxRing_init(RxRing* ring) {
+	ring->head      = 0;
+	ring->tail      = 0;
+	ring->reserved  = NULL;
+	ring->overflows = 0;
+	ring->maxDepth  = 0;
+}
+
+/**
+ * @brief   Get the payload buffer of the next free slot (producer side).
+ *
+ * @details The buffer is a FramePool block. The producer reads the frame into it and
+ *          publishes it with RxRing_commit. Only the producer may call this function.
+ *
+ * @param   ring    A pointer to the ring.
+ *
+ * @return  A LORA_MAX_PAYLOAD bytes buffer, or NULL if the ring or the pool is full (the
+ *          overflow counter is incremented and the frame must be discarded).
+ */
+uint8_t* RxRing_reserve(RxRing* ring) {
+	uint32_t head = ring->head;
+
+	if (ring->reserved == NULL) {
+		if (head - ring->tail < RX_RING_SIZE) {
+			ring->reserved = FramePool_alloc();
+		}
+		if (ring->reserved == NULL) {
+			ring->overflows++;
+		}
+	}
+	return ring->reserved;
+}
+
+/**
+ * @brief   Publish the frame read into the reserved slot (producer side).
+ *
+ * @param   ring    A pointer to the ring.
+ * @param   length  Number of payload bytes stored in the reserved buffer.
+ * @param   meta    Metadata of the frame, copied into the descriptor.
+ *
+ * @return  None
+ */
+void RxRing_commit(RxRing* ring, uint8_t length, LoRa_rxMeta* meta) {
+	uint32_t head = ring->head;
+	RxRing_frame* slot = &ring->slots[head % RX_RING_SIZE];
+
+	slot->buffer = ring->reserved;
+	ring->reserved = NULL;
+	slot->length = length;
+	memcpy(&slot->meta, meta, sizeof(LoRa_rxMeta));
+
+	// the descriptor and payload must be visible before the new head
+	__DMB();
+	ring->head = head + 1;
+
+	if (head + 1 - ring->tail > ring->maxDepth) {
+		ring->maxDepth = head + 1 - ring->tail;
+	}
+}
+
+/**
+ * @brief   Get the oldest frame waiting in the ring (consumer side).
+ *
+ * @details The frame stays valid until RxRing_release is called.
+ *
+ * @param   ring    A pointer to the ring.
+ *
+ * @return  A pointer to the frame descriptor, or NULL if the ring is empty.
+ */
+RxRing_frame* RxRing_peek(RxRing* ring) {
+	uint32_t tail = ring->tail;
+
+	if (ring->head == tail) {
+		return NULL;
+	}
+	// do not read the descriptor before the head that published it
+	__DMB();
+	return &ring->slots[tail % RX_RING_SIZE];
+}
+
+/**
+ * @brief   Get the payload of a frame descriptor.
+ *
+ * @param   ring    A pointer to the ring.
+ * @param   frame   A descriptor returned by RxRing_peek.
+ *
+ * @return  A pointer to the payload bytes.
+ */
+uint8_t* RxRing_data(RxRing* ring, RxRing_frame* frame) {
+	return frame->buffer;
+}
+
+/**
+ * @brief   Give the oldest frame back to the producer (consumer side).
+ *
+ * @details Its payload block returns to the FramePool.
+ *
+ * @param   ring    A pointer to the ring.
+ *
+ * @return  None
+ */
+void RxRing_release(RxRing* ring) {
+	FramePool_free(ring->slots[ring->tail % RX_RING_SIZE].buffer);
+	// finish reading the slot before handing it back
+	__DMB();
+	ring->tail = ring->tail + 1;
+}
+
+/**
+ * @brief   Get the number of frames waiting in the ring.
+ *
+ * @param   ring    A pointer to the ring.
+ *
+ * @return  The current depth of the ring.
+ */
+uint32_t RxRing_depth(RxRing* ring) {
+	return ring->head - ring->tail;
+}
@@ -0,0 +1,182 @@
+/**
+  ******************************************************************************
+  * @file    Scheduler.c
+  * @brief   Cooperative run-to-completion task scheduler with priorities and
+  * 		 deadlines
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Scheduler.h"
+
+static Sched_task tasks[SCHED_MAX_TASKS];
+static uint8_t taskCount = 0;
+
+/**
+ * @brief   Remove every task from the scheduler.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Sched_init() {
+	taskCount = 0;
+}
+
+/**
+ * @brief   Register a task.
+ *
+ * @details Event-driven tasks (period 0) run once per Sched_signal. Periodic tasks are
+ *          released every period_ms from the moment they are added. A task finishing more
+ *          than deadline_ms after its release counts as a deadline miss.
+ *
+ * @param   name         Name shown in the reports.
+ * @param   run          Task body, runs to completion.
+ * @param   priority     SCHED_PRIO_xxx, lower value runs first.
+ * @param   period_ms    Release period, 0 for event-driven tasks.
+ * @param   deadline_ms  Maximum time from release to completion.
+ *
+ * @return  The task id, or SCHED_NO_TASK if the table is full.
+ */
+int8_t Sched_add(const char* name, Sched_taskFn run, uint8_t priority, uint32_t period_ms, uint32_t deadline_ms) {
+	if (taskCount >= SCHED_MAX_TASKS) {
+		return SCHED_NO_TASK;
+	}
+
+	Sched_task* task = &tasks[taskCount];
+	task->name        = name;
+	task->run         = run;
+	task->priority    = priority;
+	task->period_ms   = period_ms;
+	task->deadline_ms = deadline_ms;
+	task->ready       = 0;
+	task->releaseTick = 0;
+	task->nextTick    = HAL_GetTick() + period_ms;
+	task->runs        = 0;
+	task->misses      = 0;
+	task->lateness_ms = 0;
+	task->maxRun_us   = 0;
+
+	return taskCount++;
+}
+
+/**
+ * @brief   Release an event-driven task.
+ *
+ * @details Safe to call from interrupt context. Several signals before the task runs are
+ *          merged in a single run, whose deadline counts from the first one.
+ *
+ * @param   id   Task id returned by Sched_add.
+ *
+ * @return  None
+ */
+void Sched_signal(int8_t id) {
+	if (id < 0 || id >= taskCount) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (!tasks[id].ready) {
+		tasks[id].releaseTick = HAL_GetTick();
+		tasks[id].ready = 1;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Run the highest priority ready task.
+ *
+ * @details Periodic tasks whose period elapsed are released first. Among ready tasks the
+ *          lowest priority value wins, ties go to the task registered first. Call it until
+ *          it returns 0 to drain all the pending work.
+ *
+ * @param   None
+ *
+ * @return  1 if a task ran, 0 if nothing was ready.
+ */
+uint8_t Sched_runNext() {
+	uint32_t now = HAL_GetTick();
+	Sched_task* next = NULL;
+
+	for (uint8_t i = 0; i < taskCount; i++) {
+		Sched_task* task = &tasks[i];
+		if (task->period_ms != 0 && (int32_t)(now - task->nextTick) >= 0) {
+			task->nextTick += task->period_ms;
+			// do not try to catch up after a long stall
+			if ((int32_t)(now - task->nextTick) >= 0) {
+				task->nextTick = now + task->period_ms;
+			}
+			Sched_signal(i);
+		}
+		if (task->ready && (next == NULL || task->priority < next->priority)) {
+			next = task;
+		}
+	}
+	if (next == NULL) {
+		return 0;
+	}
+
+	uint32_t release = next->releaseTick;
+	next->ready = 0;
+
+	uint32_t start = get_cycles();
+	next->run();
+	uint32_t run_us = cycles_to_us(get_cycles() - start);
+
+	next->runs++;
+	if (run_us > next->maxRun_us) {
+		next->maxRun_us = run_us;
+	}
+	uint32_t elapsed = HAL_GetTick() - release;
+	if (elapsed > next->deadline_ms) {
+		next->misses++;
+		if (elapsed - next->deadline_ms > next->lateness_ms) {
+			next->lateness_ms = elapsed - next->deadline_ms;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief   Get the number of registered tasks.
+ *
+ * @param   None
+ *
+ * @return  The number of tasks.
+ */
+uint8_t Sched_count() {
+	return taskCount;
+}
+
+/**
+ * @brief   Get a task descriptor, for reporting.
+ *
+ * @param   id   Task id returned by Sched_add.
+ *
+ * @return  A pointer to the task, or NULL if the id is not valid.
+ */
+Sched_task* Sched_get(int8_t id) {
+	if (id < 0 || id >= taskCount) {
+		return NULL;
+	}
+	return &tasks[id];
+}
+
+/**
+ * @brief   Get the total number of deadline misses.
+ *
+ * @param   None
+ *
+ * @return  The sum of the deadline misses of every task.
+ */
+uint32_t Sched_misses() {
+	uint32_t misses = 0;
+	for (uint8_t i = 0; i < taskCount; i++) {
+		misses += tasks[i].misses;
+	}
+	return misses;
+}
@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file    SerialLink.c
+  * @brief   Baud rate negotiation and flow control of the host UART
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * The UART boots at LINK_DEFAULT_BAUD without flow control, so any terminal can
+  * attach. Link_negotiate announces the new rate, switches to it with RTS/CTS
+  * and waits for the host to send LINK_CONFIRM_BYTE at that rate. Without an
+  * answer within LINK_CONFIRM_MS the UART goes back to the default settings.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "SerialLink.h"
+#include "Log.h"
+#include "LoRa.h"
+
+static UART_HandleTypeDef* linkUart = NULL;
+static Link_restartFn     linkRestart = NULL;
+static Timer              confirmTimer;
+static Link_stats         stats;
+
+/**
+ * @brief   Reconfigure the UART.
+ *
+ * @details Waits up to LINK_FLUSH_MS for the queued output, discards what is left, as a
+ *          host holding CTS would keep it forever, stops both DMA channels, applies the new
+ *          rate and flow control and restarts the reception. 8x oversampling is selected
+ *          when the rate is above PCLK1 / 16.
+ *
+ * @param   baud          New rate.
+ * @param   flowControl   1 to enable RTS/CTS.
+ *
+ * @return  HAL_OK or the error of HAL_UART_Init.
+ */
+static HAL_StatusTypeDef Link_configure(uint32_t baud, uint8_t flowControl) {
+	Log_flush(LINK_FLUSH_MS);
+	Log_discard();
+	HAL_UART_Abort(linkUart);
+
+	linkUart->Init.BaudRate = baud;
+	linkUart->Init.HwFlowCtl = flowControl ? UART_HWCONTROL_RTS_CTS : UART_HWCONTROL_NONE;
+	linkUart->Init.OverSampling = baud > HAL_RCC_GetPCLK1Freq() / 16 ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16;
+	HAL_StatusTypeDef status = HAL_UART_Init(linkUart);
+	if (status == HAL_OK) {
+		stats.baud = baud;
+		stats.flowControl = flowControl;
+	}
+
+	if (linkRestart != NULL) {
+		linkRestart();
+	}
+	return status;
+}
+
+/**
+ * @brief   Go back to the default settings when the host did not confirm.
+ *
+ * @param   arg   Unused.
+ *
+ * @return  None
+ */
+static void Link_confirmExpired(void* arg) {
+	stats.fallbacks++;
+	Link_fallback();
+	log_print("no answer from the host, back to default baud rate\r\n");
+}
+
+/**
+ * @brief   Initialize the link at the default settings.
+ *
+ * @param   huart     Host UART, already initialized by MX_UART5_Init.
+ * @param   restart   Restarts the reception after a reconfiguration.
+ *
+ * @return  None
+ */
+void Link_init(UART_HandleTypeDef* huart, Link_restartFn restart) {
+	linkUart = huart;
+	linkRestart = restart;
+	stats.baud = huart->Init.BaudRate;
+	stats.flowControl = huart->Init.HwFlowCtl == UART_HWCONTROL_RTS_CTS;
+	stats.state = LINK_DEFAULT;
+	stats.switches = 0;
+	stats.fallbacks = 0;
+}
+
+/**
+ * @brief   Switch the link to a new rate with RTS/CTS.
+ *
+ * @details The caller announces the rate before, at the current one. The switch only
+ *          holds if the host sends LINK_CONFIRM_BYTE within LINK_CONFIRM_MS. Must be
+ *          called from thread context.
+ *
+ * @param   baud   New rate.
+ *
+ * @return  LORA_OK if the UART switched and waits for the host, LORA_UNAVAILABLE if the
+ *          rate cannot be set; the link is then back at the default settings.
+ */
+uint16_t Link_negotiate(uint32_t baud) {
+	if (Link_configure(baud, 1) != HAL_OK) {
+		Link_fallback();
+		return LORA_UNAVAILABLE;
+	}
+	stats.state = LINK_CONFIRMING;
+	Timer_start(&confirmTimer, LINK_CONFIRM_MS, 0, Link_confirmExpired, NULL);
+	return LORA_OK;
+}
+
+/**
+ * @brief   Go back to LINK_DEFAULT_BAUD without flow control.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Link_fallback() {
+	Timer_stop(&confirmTimer);
+	stats.state = LINK_DEFAULT;
+	Link_configure(LINK_DEFAULT_BAUD, 0);
+}
+
+/**
+ * @brief   Check if the link waits for the host confirmation.
+ *
+ * @param   None
+ *
+ * @return  1 while confirming, otherwise 0.
+ */
+uint8_t Link_confirming() {
+	return stats.state == LINK_CONFIRMING;
+}
+
+/**
+ * @brief   Feed a received byte to the negotiation.
+ *
+ * @details While confirming every byte is consumed: LINK_CONFIRM_BYTE completes the
+ *          switch, anything else is noise from the change of rate.
+ *
+ * @param   byte   Received byte.
+ *
+ * @return  1 if the byte was consumed, 0 if it belongs to the console.
+ */
+uint8_t Link_onByte(uint8_t byte) {
+	if (stats.state != LINK_CONFIRMING) {
+		return 0;
+	}
+	if (byte == LINK_CONFIRM_BYTE) {
+		Timer_stop(&confirmTimer);
+		stats.state = LINK_FAST;
+		stats.switches++;
+	}
+	return 1;
+}
+
+/**
+ * @brief   Get the link settings and statistics.
+ *
+ * @param   out   Where the statistics are stored.
+ *
+ * @return  None
+ */
+void Link_getStats(Link_stats* out) {
+	*out = stats;
+}
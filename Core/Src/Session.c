@@ -0,0 +1,223 @@
+/**
+  ******************************************************************************
+  * @file    Session.c
+  * @brief   Request/response command sessions multiplexed on one radio
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Session.h"
+#include <string.h>
+
+static Session sessions[SESSION_MAX];
+static Session_sendFn sessionSend = NULL;
+static Session_busyFn sessionBusy = NULL;
+static Session_wakeFn sessionWake = NULL;
+static uint32_t sessionCount = 0;     // sessions started since boot
+
+/**
+ * @brief   Initialize the session table.
+ *
+ * @param   send   Builds and transmits a frame, e.g. sendFrame.
+ * @param   busy   Returns non zero while the radio can not take a new frame.
+ * @param   wake   Schedules a Session_runAll, e.g. by signalling the session task.
+ *
+ * @return  None
+ */
+void Session_init(Session_sendFn send, Session_busyFn busy, Session_wakeFn wake) {
+	sessionSend = send;
+	sessionBusy = busy;
+	sessionWake = wake;
+	for (uint8_t i = 0; i < SESSION_MAX; i++) {
+		Timer_stop(&sessions[i].timer);
+		sessions[i].active = 0;
+	}
+}
+
+/**
+ * @brief   Response timeout of a session, run from Timer_dispatch.
+ *
+ * @param   arg   The session.
+ *
+ * @return  None
+ */
+static void Session_timeout(void* arg) {
+	Session* s = (Session*)arg;
+	s->timedOut = 1;
+	if (sessionWake != NULL) {
+		sessionWake();
+	}
+}
+
+/**
+ * @brief   Start a new session.
+ *
+ * @details The session runs on the next Session_runAll and every time after, until its
+ *          thread ends. The wake hook is called so that run happens straight away.
+ *
+ * @param   name     Name shown in the reports.
+ * @param   thread   Coroutine implementing the exchange.
+ * @param   arg      Free argument, available as s->arg.
+ *
+ * @return  A pointer to the session, or NULL if every slot is in use.
+ */
+Session* Session_start(const char* name, Session_thread thread, uint32_t arg) {
+	for (uint8_t i = 0; i < SESSION_MAX; i++) {
+		Session* s = &sessions[i];
+		if (!s->active) {
+			memset(s, 0, sizeof(Session));
+			CORO_INIT(&s->coro);
+			s->thread = thread;
+			s->name   = name;
+			s->arg    = arg;
+			s->expect = SESSION_NO_RESPONSE;
+			s->active = 1;
+			s->sequence = sessionCount++;
+			if (sessionWake != NULL) {
+				sessionWake();
+			}
+			return s;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief   Hand a received frame to the session waiting for it.
+ *
+ * @details The oldest-started session awaiting this function ID gets the optional data.
+ *
+ * @param   functionId   Function ID of the received frame.
+ * @param   optData      Optional data of the frame.
+ * @param   optDataLen   Length of the optional data.
+ *
+ * @return  1 if a session took the frame, otherwise 0.
+ */
+uint8_t Session_deliver(uint8_t functionId, uint8_t* optData, uint8_t optDataLen) {
+	Session* oldest = NULL;
+	for (uint8_t i = 0; i < SESSION_MAX; i++) {
+		Session* s = &sessions[i];
+		if (s->active && !s->received && s->expect == functionId &&
+				(oldest == NULL || (int32_t)(s->sequence - oldest->sequence) < 0)) {
+			oldest = s;
+		}
+	}
+	if (oldest == NULL) {
+		return 0;
+	}
+	if (optDataLen > 0) {
+		memcpy(oldest->response, optData, optDataLen);
+	}
+	oldest->responseLen = optDataLen;
+	oldest->received = 1;
+	Timer_stop(&oldest->timer);
+	return 1;
+}
+
+/**
+ * @brief   Resume every active session once.
+ *
+ * @param   None
+ *
+ * @return  The number of sessions still active.
+ */
+uint8_t Session_runAll() {
+	uint8_t active = 0;
+	for (uint8_t i = 0; i < SESSION_MAX; i++) {
+		Session* s = &sessions[i];
+		if (!s->active) {
+			continue;
+		}
+		if (s->thread(s) == CORO_ENDED) {
+			s->active = 0;
+		} else {
+			active++;
+		}
+	}
+	return active;
+}
+
+/**
+ * @brief   Get the number of active sessions.
+ *
+ * @param   None
+ *
+ * @return  The number of active sessions.
+ */
+uint8_t Session_active() {
+	uint8_t active = 0;
+	for (uint8_t i = 0; i < SESSION_MAX; i++) {
+		active += sessions[i].active;
+	}
+	return active;
+}
+
+/**
+ * @brief   Check if the radio can take a new frame (used by SESSION_SEND).
+ *
+ * @param   None
+ *
+ * @return  Non zero while the radio is busy.
+ */
+uint8_t Session_radioBusy() {
+	return sessionBusy != NULL && sessionBusy();
+}
+
+/**
+ * @brief   Transmit a frame for a session (used by SESSION_SEND).
+ *
+ * @param   functionId   Function ID of the frame.
+ * @param   optDataLen   Length of the optional data.
+ * @param   optData      Optional data, NULL if optDataLen is 0.
+ *
+ * @return  None
+ */
+void Session_send(uint8_t functionId, uint8_t optDataLen, uint8_t* optData) {
+	if (sessionSend != NULL) {
+		sessionSend(functionId, optDataLen, optData);
+	}
+}
+
+/**
+ * @brief   Arm the wait for a response (used by SESSION_AWAIT).
+ *
+ * @details The timeout runs on the timer wheel, which wakes the session when it expires.
+ *
+ * @param   s            The session.
+ * @param   responseId   Expected function ID.
+ * @param   timeout_ms   Time to wait for it.
+ *
+ * @return  None
+ */
+void Session_expect(Session* s, uint8_t responseId, uint32_t timeout_ms) {
+	s->received = 0;
+	s->responseLen = 0;
+	s->timedOut = 0;
+	s->expect = responseId;
+	Timer_start(&s->timer, timeout_ms, 0, Session_timeout, s);
+}
+
+/**
+ * @brief   Check if the awaited response arrived or timed out (used by SESSION_AWAIT).
+ *
+ * @details Sets s->status and stops waiting once it returns 1.
+ *
+ * @param   s   The session.
+ *
+ * @return  1 when the wait is over, otherwise 0.
+ */
+uint8_t Session_settled(Session* s) {
+	if (s->received) {
+		s->status = SESSION_OK;
+	} else if (s->timedOut) {
+		s->status = SESSION_TIMEOUT;
+	} else {
+		return 0;
+	}
+	Timer_stop(&s->timer);
+	s->expect = SESSION_NO_RESPONSE;
+	return 1;
+}
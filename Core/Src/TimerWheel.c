@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file    TimerWheel.c
+  * @brief   Hierarchical software timer wheel driven by SysTick
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * Three levels of 32 slots with 1 ms, 32 ms and 1024 ms resolution. Timer_tick
+  * runs from the SysTick interrupt: it cascades the upper levels when the lower
+  * one wraps and moves the timers due this tick to the expired list, then calls
+  * the notify hook so the main loop wakes up. Callbacks run from Timer_dispatch,
+  * in the main loop, never in interrupt context.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "TimerWheel.h"
+
+static Timer*           wheel[TIMER_LEVELS][TIMER_SLOTS];
+static Timer*           expired = NULL;
+static volatile uint32_t now = 0;
+static Timer_notifyFn   timerNotify = NULL;
+
+/**
+ * @brief   Link a timer at the head of a list.
+ *
+ * @param   list   The list.
+ * @param   t      The timer, not linked anywhere.
+ *
+ * @return  None
+ */
+static void Timer_link(Timer** list, Timer* t) {
+	t->prev = NULL;
+	t->next = *list;
+	if (*list != NULL) {
+		(*list)->prev = t;
+	}
+	*list = t;
+	t->list = list;
+}
+
+/**
+ * @brief   Unlink a timer from the list holding it.
+ *
+ * @param   t   The timer.
+ *
+ * @return  None
+ */
+static void Timer_unlink(Timer* t) {
+	if (t->list == NULL) {
+		return;
+	}
+	if (t->prev != NULL) {
+		t->prev->next = t->next;
+	} else {
+		*t->list = t->next;
+	}
+	if (t->next != NULL) {
+		t->next->prev = t->prev;
+	}
+	t->next = t->prev = NULL;
+	t->list = NULL;
+}
+
+/**
+ * @brief   Put an armed timer in the slot matching its distance to now.
+ *
+ * @details Timers already due go to the expired list. Timers beyond TIMER_RANGE are parked
+ *          in the farthest slot of the last level and placed again when it cascades.
+ *          Must be called with interrupts disabled or from Timer_tick.
+ *
+ * @param   t   The timer.
+ *
+ * @return  None
+ */
+static void Timer_place(Timer* t) {
+	uint32_t delta = t->expires - now;
+
+	if ((int32_t)delta <= 0) {
+		t->state = TIMER_EXPIRED;
+		Timer_link(&expired, t);
+		return;
+	}
+
+	t->state = TIMER_ARMED;
+	for (uint8_t level = 0; level < TIMER_LEVELS; level++) {
+		if (delta < (1UL << (TIMER_SLOT_BITS * (level + 1)))) {
+			uint8_t slot = (t->expires >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK;
+			Timer_link(&wheel[level][slot], t);
+			return;
+		}
+	}
+	uint8_t level = TIMER_LEVELS - 1;
+	uint8_t slot = ((now + TIMER_RANGE - 1) >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK;
+	Timer_link(&wheel[level][slot], t);
+}
+
+/**
+ * @brief   Move every timer of an upper level slot down to where it belongs now.
+ *
+ * @param   level   Wheel level.
+ * @param   slot    Slot of that level.
+ *
+ * @return  None
+ */
+static void Timer_cascade(uint8_t level, uint8_t slot) {
+	Timer* t = wheel[level][slot];
+	wheel[level][slot] = NULL;
+	while (t != NULL) {
+		Timer* next = t->next;
+		t->list = NULL;
+		Timer_place(t);
+		t = next;
+	}
+}
+
+/**
+ * @brief   Initialize the timer wheel.
+ *
+ * @param   notify   Called from the SysTick interrupt when timers expire, e.g. to post a
+ *                   main loop event. May be NULL.
+ *
+ * @return  None
+ */
+void Timer_init(Timer_notifyFn notify) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t level = 0; level < TIMER_LEVELS; level++) {
+		for (uint8_t slot = 0; slot < TIMER_SLOTS; slot++) {
+			wheel[level][slot] = NULL;
+		}
+	}
+	expired = NULL;
+	timerNotify = notify;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Arm a timer, re-arming it if it was already armed.
+ *
+ * @details Safe to call from interrupt context.
+ *
+ * @param   t           The timer, owned by the caller.
+ * @param   delay_ms    Time to the first expiry, at least 1 ms.
+ * @param   period_ms   Reload period, 0 for a one-shot timer.
+ * @param   callback    Run from Timer_dispatch on every expiry.
+ * @param   arg         Passed to the callback.
+ *
+ * @return  None
+ */
+void Timer_start(Timer* t, uint32_t delay_ms, uint32_t period_ms, Timer_callback callback, void* arg) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Timer_unlink(t);
+	t->callback = callback;
+	t->arg = arg;
+	t->period = period_ms;
+	t->expires = now + (delay_ms > 0 ? delay_ms : 1);
+	Timer_place(t);
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Disarm a timer. An expiry not yet dispatched is discarded.
+ *
+ * @details Safe to call from interrupt context and on timers that are not armed.
+ *
+ * @param   t   The timer.
+ *
+ * @return  None
+ */
+void Timer_stop(Timer* t) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Timer_unlink(t);
+	t->state = TIMER_IDLE;
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Check if a timer is armed or has an expiry pending dispatch.
+ *
+ * @param   t   The timer.
+ *
+ * @return  1 if the timer is armed or expired, 0 if it is idle.
+ */
+uint8_t Timer_armed(Timer* t) {
+	return t->state != TIMER_IDLE;
+}
+
+/**
+ * @brief   Advance the wheel by one millisecond.
+ *
+ * @details Call it from SysTick_Handler, after HAL_IncTick.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Timer_tick() {
+	now++;
+
+	uint8_t slot = now & TIMER_SLOT_MASK;
+	if (slot == 0) {
+		uint8_t slot1 = (now >> TIMER_SLOT_BITS) & TIMER_SLOT_MASK;
+		if (slot1 == 0) {
+			Timer_cascade(2, (now >> (2 * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK);
+		}
+		Timer_cascade(1, slot1);
+	}
+
+	Timer* t = wheel[0][slot];
+	wheel[0][slot] = NULL;
+	while (t != NULL) {
+		Timer* next = t->next;
+		t->list = NULL;
+		t->state = TIMER_EXPIRED;
+		Timer_link(&expired, t);
+		t = next;
+	}
+
+	if (expired != NULL && timerNotify != NULL) {
+		timerNotify();
+	}
+}
+
+/**
+ * @brief   Run the callbacks of the expired timers and re-arm the periodic ones.
+ *
+ * @details Call it from the main loop when the notify hook fires. A periodic timer that
+ *          fell behind by more than one period skips the missed expiries.
+ *
+ * @param   None
+ *
+ * @return  The number of callbacks run.
+ */
+uint8_t Timer_dispatch() {
+	uint8_t count = 0;
+
+	while (1) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		Timer* t = expired;
+		if (t == NULL) {
+			__set_PRIMASK(primask);
+			break;
+		}
+		Timer_unlink(t);
+		Timer_callback callback = t->callback;
+		void* arg = t->arg;
+		if (t->period > 0) {
+			t->expires += t->period;
+			if ((int32_t)(t->expires - now) <= 0) {
+				t->expires = now + t->period;
+			}
+			Timer_place(t);
+		} else {
+			t->state = TIMER_IDLE;
+		}
+		__set_PRIMASK(primask);
+
+		if (callback != NULL) {
+			callback(arg);
+		}
+		count++;
+	}
+	return count;
+}
+
+/**
+ * @brief   Get the wheel time.
+ *
+ * @param   None
+ *
+ * @return  Milliseconds counted by Timer_tick since boot.
+ */
+uint32_t Timer_now() {
+	return now;
+}
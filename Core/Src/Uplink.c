@@ -0,0 +1,278 @@
+/**
+  ******************************************************************************
+  * @file    Uplink.c
+  * @brief   Bounded queue of uplink commands drained back to back during a pass
+  * @author  Alejandro Murgui Dolz
+  * @version V1.0
+  * @date    17-October-2026
+  ******************************************************************************
+  * While one frame is on air the next queued command is already encoded in a
+  * FramePool block, so it can be loaded as soon as TxDone fires. A gap is only
+  * left after a command that expects a response, until the response arrives or
+  * the response window expires.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "Uplink.h"
+#include "PLUTON-Comms.h"
+#include "Correlator.h"
+#include "FramePool.h"
+#include <string.h>
+
+static char*          uplinkCallsign = NULL;
+static uint16_t       uplinkWindow = 0;
+static Uplink_transmitFn uplinkTransmit = NULL;
+static Uplink_wakeFn  uplinkWake = NULL;
+
+// pending commands
+static Uplink_cmd     queue[UPLINK_QUEUE_SIZE];
+static uint8_t        queueHead = 0;
+static uint8_t        queueTail = 0;
+static uint8_t        queueCount = 0;
+
+// next encoded frame
+static uint8_t*       stagedFrame = NULL;   // FramePool block
+static uint8_t        stagedLen = 0;
+static uint8_t        stagedId = 0;
+static uint8_t        stagedExpect = 0;
+static uint32_t       stagedStart = 0;
+static uint8_t        stagedValid = 0;
+// frame on air
+static volatile uint8_t onAir = 0;
+static uint8_t        onAirId = 0;
+static uint8_t        onAirExpect = 0;
+
+// response window
+static volatile uint8_t waiting = 0;
+static uint8_t        waitingId = 0;
+static Timer          windowTimer;
+
+static Uplink_stats   stats;
+static uint32_t       burstStart = 0;
+static uint32_t       burstSent = 0;
+static uint32_t       burstEnd = 0;
+
+/**
+ * @brief   Initialize the uplink queue.
+ *
+ * @param   callsign    Callsign written in every frame.
+ * @param   window_ms   Time left for the response of a command that expects one.
+ * @param   transmit    Starts an asynchronous transmission and returns LORA_OK or
+ *                      LORA_BUSY; its completion must be reported with Uplink_txDone.
+ * @param   wake        Schedules an Uplink_poll, called when a response window closes.
+ *
+ * @return  None
+ */
+void Uplink_init(char* callsign, uint16_t window_ms, Uplink_transmitFn transmit, Uplink_wakeFn wake) {
+	uplinkCallsign = callsign;
+	uplinkWindow = window_ms;
+	uplinkTransmit = transmit;
+	uplinkWake = wake;
+	Timer_stop(&windowTimer);
+	FramePool_free(stagedFrame);
+	stagedFrame = NULL;
+	queueHead = queueTail = queueCount = 0;
+	stagedValid = onAir = waiting = 0;
+	memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief   Queue a command for transmission.
+ *
+ * @param   functionId       Function ID of the command.
+ * @param   optDataLen       Length of the optional data, at most UPLINK_MAX_OPTDATA.
+ * @param   optData          Optional data, copied into the queue.
+ * @param   expectResponse   Non zero to wait for the response before the next command.
+ *
+ * @return  LORA_OK, LORA_BUSY if the queue is full or LORA_LARGE_PAYLOAD if the optional
+ *          data does not fit in the queue or in a frame.
+ */
+uint16_t Uplink_push(uint8_t functionId, uint8_t optDataLen, uint8_t* optData, uint8_t expectResponse) {
+	if (optDataLen > UPLINK_MAX_OPTDATA ||
+			PCP_Get_Frame_Length(uplinkCallsign, optDataLen) > LORA_MAX_PAYLOAD) {
+		return LORA_LARGE_PAYLOAD;
+	}
+	if (queueCount >= UPLINK_QUEUE_SIZE) {
+		stats.dropped++;
+		return LORA_BUSY;
+	}
+
+	// a new burst starts when the queue was drained
+	if (Uplink_idle()) {
+		burstSent = 0;
+	}
+
+	Uplink_cmd* cmd = &queue[queueHead];
+	cmd->functionId = functionId;
+	cmd->optDataLen = optDataLen;
+	if (optDataLen > 0) {
+		memcpy(cmd->optData, optData, optDataLen);
+	}
+	cmd->expectResponse = expectResponse;
+	queueHead = (queueHead + 1) % UPLINK_QUEUE_SIZE;
+	queueCount++;
+
+	if (queueCount + stagedValid > stats.maxDepth) {
+		stats.maxDepth = queueCount + stagedValid;
+	}
+	return LORA_OK;
+}
+
+/**
+ * @brief   Encode the oldest queued command into the staging block.
+ *
+ * @details The command stays queued if no FramePool block is free.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void Uplink_stage() {
+	if (stagedValid || queueCount == 0) {
+		return;
+	}
+
+	if (stagedFrame == NULL) {
+		stagedFrame = FramePool_alloc();
+		if (stagedFrame == NULL) {
+			return;
+		}
+	}
+
+	Uplink_cmd* cmd = &queue[queueTail];
+	int16_t len = PCP_Get_Frame_Length(uplinkCallsign, cmd->optDataLen);
+	stagedStart = get_cycles();
+	if (len > 0 && len <= LORA_MAX_PAYLOAD) {
+		PCP_Encode(stagedFrame, uplinkCallsign, cmd->functionId, cmd->optDataLen, cmd->optData);
+		stagedLen = len;
+		stagedId = cmd->functionId;
+		stagedExpect = cmd->expectResponse;
+		stagedValid = 1;
+	}
+	queueTail = (queueTail + 1) % UPLINK_QUEUE_SIZE;
+	queueCount--;
+}
+
+/**
+ * @brief   Response window expired, run from Timer_dispatch.
+ *
+ * @param   arg   Unused.
+ *
+ * @return  None
+ */
+static void Uplink_windowExpired(void* arg) {
+	if (waiting) {
+		waiting = 0;
+		stats.noResponse++;
+	}
+	if (uplinkWake != NULL) {
+		uplinkWake();
+	}
+}
+
+/**
+ * @brief   Advance the uplink: start the staged frame when the channel is free and encode
+ *          the next one while it is on air.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+void Uplink_poll() {
+	if (uplinkTransmit == NULL) {
+		return;
+	}
+
+	Uplink_stage();
+	if (stagedValid && !onAir && !waiting) {
+		onAirId = stagedId;
+		onAirExpect = stagedExpect;
+		onAir = 1;
+		if (uplinkTransmit(stagedFrame, stagedLen) != LORA_OK) {
+			onAir = 0;
+			return;
+		}
+		Corr_sent(stagedId, stagedStart);
+		if (burstSent == 0) {
+			burstStart = HAL_GetTick();
+		}
+		stats.sent++;
+		burstSent++;
+		burstEnd = HAL_GetTick();
+
+		// pipeline: the transmitter keeps its own copy, encode the next command into the
+		// same block while this one is on air
+		stagedValid = 0;
+		Uplink_stage();
+		if (!stagedValid) {
+			FramePool_free(stagedFrame);
+			stagedFrame = NULL;
+		}
+	}
+}
+
+/**
+ * @brief   Notify the end of an uplink transmission.
+ *
+ * @details Call it from the transmission-complete callback of the transmit function given
+ *          to Uplink_init. Does nothing if the transmission was not started by the queue.
+ *
+ * @param   success   Non zero on TxDone, zero on transmission timeout.
+ *
+ * @return  None
+ */
+void Uplink_txDone(uint8_t success) {
+	if (!onAir) {
+		return;
+	}
+	onAir = 0;
+	if (!success) {
+		stats.failed++;
+	} else if (onAirExpect) {
+		waitingId = onAirId + RESPONSE_OFFSET;
+		waiting = 1;
+		Timer_start(&windowTimer, uplinkWindow, 0, Uplink_windowExpired, NULL);
+	}
+}
+
+/**
+ * @brief   Notify a received frame, closing the response window it answers.
+ *
+ * @param   functionId   Function ID of the received frame.
+ *
+ * @return  None
+ */
+void Uplink_response(uint8_t functionId) {
+	if (waiting && functionId == waitingId) {
+		Timer_stop(&windowTimer);
+		waiting = 0;
+	}
+}
+
+/**
+ * @brief   Check if the queue is drained.
+ *
+ * @param   None
+ *
+ * @return  1 if nothing is queued, staged, on air or awaiting a response.
+ */
+uint8_t Uplink_idle() {
+	return queueCount == 0 && !stagedValid && !onAir && !waiting;
+}
+
+/**
+ * @brief   Get the queue statistics.
+ *
+ * @param   stats   Where the statistics are stored.
+ *
+ * @return  None
+ */
+void Uplink_getStats(Uplink_stats* out) {
+	memcpy(out, &stats, sizeof(Uplink_stats));
+	out->depth = queueCount + stagedValid;
+	out->perMinute = 0;
+	if (burstSent > 1 && burstEnd != burstStart) {
+		out->perMinute = (burstSent - 1) * 60000 / (burstEnd - burstStart);
+	}
+}
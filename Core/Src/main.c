@@ -18,6 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "spi.h"
 #include "usart.h"
 #include "gpio.h"
@@ -25,6 +26,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 //#include "Main_App.h"
+#include "Log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -57,7 +59,32 @@ void SystemClock_Config(void);
 /* USER CODE BEGIN 0 */
 void delay_ms(uint32_t ms) {
 	uint32_t start = HAL_GetTick(); // Obtiene el tiempo inicial
-	while ((HAL_GetTick() - start) < ms);
+	// duerme hasta la siguiente interrupción (SysTick cada 1 ms) en vez de esperar activamente
+	while ((HAL_GetTick() - start) < ms) {
+		__WFI();
+	}
+}
+
+// Contador de ciclos del DWT para medidas y esperas de microsegundos
+void cycles_init(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t get_cycles(void) {
+	return DWT->CYCCNT;
+}
+
+uint32_t cycles_to_us(uint32_t cycles) {
+	return cycles / (SystemCoreClock / 1000000U);
+}
+
+void delay_us(uint32_t us) {
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles = us * (SystemCoreClock / 1000000U);
+	while ((DWT->CYCCNT - start) < cycles);
 }
 /* USER CODE END 0 */
 
@@ -84,11 +111,13 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+	cycles_init();
 
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_UART5_Init();
   MX_SPI1_Init();
   /* USER CODE BEGIN 2 */
@@ -104,7 +133,7 @@ int main(void)
 	while (1)
 	{
 		//------------MAIN APP LOOP-----------------
-		LoraApp_loopReceive();
+		LoraApp_loop();
 		//------------------------------------------
     /* USER CODE END WHILE */
 
@@ -160,10 +189,22 @@ void SystemClock_Config(void)
 
 /* USER CODE BEGIN 4 */
 //---------------------UART INTERRUPTION----------------------------------
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+	if (huart == &huart5) {
+		//Mitad, final de buffer o linea inactiva: se publica el bloque, se procesa en el bucle principal
+		onSerialChunk(Size);
+	}
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+	//El DMA ha enviado un bloque del buffer de salida, se lanza el siguiente
+	Log_onTxComplete(huart);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	Log_onError(huart);
 	if (huart == &huart5) {
-		LoraApp_loopSerial();
-		delay_ms(1000);
+		onSerialError();
 	}
 }
 //------------------------------------------------------------------------
@@ -175,6 +216,26 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
 	}
 }
 //------------------------------------------------------------------------
+//---------------------SPI1 DMA INTERRUPTION------------------------------
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi){
+	if(hspi == &hspi1){
+		onSPITransferComplete();
+	}
+}
+
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi){
+	if(hspi == &hspi1){
+		onSPITransferComplete();
+	}
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi){
+	if(hspi == &hspi1){
+		//Se libera el bus aunque la transferencia haya fallado
+		onSPITransferComplete();
+	}
+}
+//------------------------------------------------------------------------
 /* USER CODE END 4 */
 
 /**